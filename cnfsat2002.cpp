@@ -7,319 +7,8148 @@
  * This program reads CNF formulas from a file and validates them by checking
  * if clauses are valid. A clause is considered valid if it contains
  * both a literal and its negation (making it always true).
+ *
+ * Input files may be plain DIMACS or compressed with xz, gzip or bzip2; the
+ * format is detected from the magic bytes. Each decompressor is compiled in
+ * when its header is found and needs the matching library when linking:
+ *
+ * @code
+ * g++ -O2 -std=c++17 cnfsat2002.cpp -pthread -llzma -lz -lbz2
+ * @endcode
+ *
+ * Define CNFSAT_NO_XZ, CNFSAT_NO_GZIP or CNFSAT_NO_BZIP2 to leave one out.
  */
 
 #include<fstream>
 #include<iostream>
 #include<string>
 #include<sstream>
-#include<unordered_set>
+#include<vector>
+#include<map>
+#include<unordered_map>
+#include<algorithm>
+#include<cstdint>
+#include<cstring>
 #include <filesystem>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <queue>
+#include <new>
+#include <cstdlib>
+#include <climits>
+#include <numeric>
+#include <cmath>
+
+#ifdef _WIN32
+#define NOMINMAX
 #include <windows.h>
 #include <psapi.h>
+#include <malloc.h>
+#else
+#include <sys/resource.h>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if __has_include(<lzma.h>) && !defined(CNFSAT_NO_XZ)
+#define CNFSAT_HAVE_LZMA 1
+#include <lzma.h>
+#endif
+#if __has_include(<zlib.h>) && !defined(CNFSAT_NO_GZIP)
+#define CNFSAT_HAVE_ZLIB 1
+#include <zlib.h>
+#endif
+#if __has_include(<bzlib.h>) && !defined(CNFSAT_NO_BZIP2)
+#define CNFSAT_HAVE_BZIP2 1
+#include <bzlib.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CNFSAT_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
 
 using namespace std;
 namespace fs = std::filesystem;
 
+/// Number of bytes read from a CNF file per chunk of the clause body.
+const size_t DIMACS_CHUNK_SIZE = 1 << 20;
+
+/// Slack kept after every chunk so vector loads may run past its last byte.
+const size_t DIMACS_PADDING = 64;
+
 /**
- * @brief Counts the number of valid clauses in a CNF formula file
- * 
- * A clause is considered valid if it contains both a literal and its negation
- * (e.g., x and -x), which makes the clause always satisfiable (tautology).
- * 
- * @param filepath Path to the CNF file in DIMACS format
- * @return int Number of valid clauses found, or -1 if file cannot be opened
- * 
- * @note The CNF file should follow DIMACS format:
- *       - Header line: p cnf <num_variables> <num_clauses>
- *       - Each clause line contains space-separated integers ending with 0
- *       - Negative numbers represent negated literals
- * 
- * @warning This function opens and reads the file each time it's called
+ * @brief Consumes one token of the DIMACS clause body
+ *
+ * A token is either a literal (appended to @p lits, with 0 marking the end
+ * of a clause), a single whitespace character, or a whole line that is not
+ * part of the clause body (comments), which is skipped.
+ *
+ * @param p Current position, always at a token boundary
+ * @param end End of the buffer
+ * @param lits Output literal stream
+ * @param more Set to false when the '%' end marker used by the SAT2002
+ *             uniform random instances is reached
+ * @return const char* Position just past the consumed token
+ */
+inline const char* parse_token_scalar(const char* p, const char* end, vector<int>& lits, bool& more)
+{
+    char c = *p;
+    if(c == '-' || (c >= '0' && c <= '9'))
+    {
+        bool neg = (c == '-');
+        if(neg) p++;
+        int no = 0;
+        while(p < end && *p >= '0' && *p <= '9')
+        {
+            no = no*10 + (*p - '0');
+            p++;
+        }
+        lits.push_back(neg ? -no : no);
+    }
+    else if(c == ' ' || c == '\n' || c == '\t' || c == '\r')
+    {
+        p++;
+    }
+    else if(c == '%')
+    {
+        more = false;
+        p = end;
+    }
+    else
+    {
+        // Comment or any other non-clause line
+        while(p < end && *p != '\n') p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Portable byte-at-a-time parser for a chunk of the clause body
+ *
+ * @param p Start of the chunk (at a token boundary)
+ * @param end End of the chunk (at a token boundary)
+ * @param lits Output literal stream, 0 terminates each clause
+ * @return bool False once the '%' end marker was seen
+ */
+bool parse_literals_scalar(const char* p, const char* end, vector<int>& lits)
+{
+    bool more = true;
+    while(p < end && more)
+    {
+        p = parse_token_scalar(p, end, lits, more);
+    }
+    return more;
+}
+
+#ifdef CNFSAT_HAVE_AVX2_KERNEL
+
+/**
+ * @brief Shuffle masks that right-align a run of @c len digits into lanes 0..7
+ *
+ * Entry @c len moves the first @c len bytes of a 16-byte load to the end of
+ * the low 8 lanes and zeroes everything else, so a single multiply-add chain
+ * can convert runs of any length up to 8.
+ */
+struct DigitShuffleTable
+{
+    alignas(16) unsigned char mask[9][16];
+
+    DigitShuffleTable()
+    {
+        for(int len = 0; len <= 8; len++)
+        {
+            for(int i = 0; i < 16; i++)
+            {
+                mask[len][i] = (i < 8 && i >= 8-len) ? (unsigned char)(i-(8-len)) : 0x80;
+            }
+        }
+    }
+};
+
+static const DigitShuffleTable digit_shuffle;
+
+/**
+ * @brief Converts a run of at most 8 ASCII digits with SSE multiply-add
+ * @param q First digit; 16 bytes from here must be readable
+ * @param len Number of digits (1..8)
+ */
+__attribute__((target("avx2")))
+inline int convert_digits8(const char* q, int len)
+{
+    __m128i raw = _mm_loadu_si128((const __m128i*)q);
+    __m128i d = _mm_sub_epi8(raw, _mm_set1_epi8('0'));
+    d = _mm_shuffle_epi8(d, _mm_load_si128((const __m128i*)digit_shuffle.mask[len]));
+    __m128i t = _mm_maddubs_epi16(d, _mm_setr_epi8(10,1,10,1,10,1,10,1,10,1,10,1,10,1,10,1));
+    t = _mm_madd_epi16(t, _mm_setr_epi16(100,1,100,1,100,1,100,1));
+    t = _mm_packus_epi32(t, t);
+    t = _mm_madd_epi16(t, _mm_setr_epi16(10000,1,10000,1,10000,1,10000,1));
+    return _mm_cvtsi128_si32(t);
+}
+
+/**
+ * @brief AVX2 parser for a chunk of the clause body
+ *
+ * Classifies 32 bytes at a time into digits, '-' signs and whitespace.
+ * Each digit run is located from the movemask bits and converted with
+ * convert_digits8(); runs longer than 8 digits fall back to scalar code.
+ * Blocks containing anything other than digits, '-' and whitespace
+ * (comments, the '%' marker) are handed to parse_token_scalar().
+ *
+ * @param p Start of the chunk (at a token boundary)
+ * @param end End of the chunk (at a token boundary), followed by at least
+ *            DIMACS_PADDING readable bytes
+ * @param lits Output literal stream, 0 terminates each clause
+ * @return bool False once the '%' end marker was seen
+ */
+__attribute__((target("avx2")))
+bool parse_literals_avx2(const char* p, const char* end, vector<int>& lits)
+{
+    const __m256i below_zero = _mm256_set1_epi8('0'-1);
+    const __m256i above_nine = _mm256_set1_epi8('9'+1);
+    const __m256i minus = _mm256_set1_epi8('-');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    bool more = true;
+
+    while(end - p >= 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, below_zero), _mm256_cmpgt_epi8(above_nine, v));
+        __m256i is_minus = _mm256_cmpeq_epi8(v, minus);
+        __m256i is_space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, newline)),
+                                           _mm256_or_si256(_mm256_cmpeq_epi8(v, tab), _mm256_cmpeq_epi8(v, cr)));
+        uint32_t digits = (uint32_t)_mm256_movemask_epi8(is_digit);
+        uint32_t signs = (uint32_t)_mm256_movemask_epi8(is_minus);
+        uint32_t plain = digits | signs | (uint32_t)_mm256_movemask_epi8(is_space);
+
+        if(plain != 0xFFFFFFFFu)
+        {
+            // Let the scalar code step over the first unusual byte (and its line)
+            const char* stop = p + __builtin_ctz(~plain);
+            while(p <= stop && more)
+            {
+                p = parse_token_scalar(p, end, lits, more);
+            }
+            if(!more) return false;
+            continue;
+        }
+
+        // p is at a token boundary, so bit 0 may start a run; a trailing
+        // '-' is left for the next block so that its sign stays visible
+        uint32_t starts = digits & ~(digits << 1);
+        const char* next = (signs >> 31) ? p + 31 : p + 32;
+
+        while(starts)
+        {
+            int s = __builtin_ctz(starts);
+            starts &= starts - 1;
+            const char* q = p + s;
+            int len = __builtin_ctzll(~(uint64_t)(digits >> s));
+            bool neg = (s > 0) && ((signs >> (s-1)) & 1);
+
+            if(s + len == 32)
+            {
+                // The run continues past this block
+                const char* r = p + 32;
+                while(r < end && *r >= '0' && *r <= '9') r++;
+                len = (int)(r - q);
+                next = r;
+            }
+
+            int no;
+            if(len <= 8)
+            {
+                no = convert_digits8(q, len);
+            }
+            else
+            {
+                no = 0;
+                for(int k = 0; k < len; k++) no = no*10 + (q[k] - '0');
+            }
+            lits.push_back(neg ? -no : no);
+        }
+        p = next;
+    }
+
+    // Tail shorter than one block
+    while(p < end && more)
+    {
+        p = parse_token_scalar(p, end, lits, more);
+    }
+    return more;
+}
+
+#endif
+
+/// Signature shared by the clause body parsers.
+typedef bool (*LiteralParser)(const char*, const char*, vector<int>&);
+
+/**
+ * @brief Picks the fastest clause body parser supported by the running CPU
+ * @return LiteralParser parse_literals_avx2() when AVX2 is available,
+ *         parse_literals_scalar() otherwise
+ */
+LiteralParser select_literal_parser()
+{
+#ifdef CNFSAT_HAVE_AVX2_KERNEL
+    if(__builtin_cpu_supports("avx2")) return parse_literals_avx2;
+#endif
+    return parse_literals_scalar;
+}
+
+/// Size of the blocks handed from a decompression thread to the parser.
+const size_t DECOMPRESS_BLOCK_SIZE = 1 << 20;
+
+/// Number of decompressed blocks that may be waiting for the parser.
+const size_t DECOMPRESS_QUEUE_DEPTH = 4;
+
+/**
+ * @class ByteSource
+ * @brief A sequential stream of bytes that DimacsReader parses
+ */
+class ByteSource
+{
+    public:
+        virtual ~ByteSource() {}
+
+        /**
+         * @brief Reads up to @p n bytes into @p dst
+         * @return size_t Number of bytes read; 0 only at the end of the stream
+         */
+        virtual size_t read(char* dst, size_t n) = 0;
+
+        /**
+         * @brief Repositions the stream at byte @p offset
+         * @return bool False if the stream cannot seek (compressed input)
+         */
+        virtual bool seek(uintmax_t offset)
+        {
+            (void)offset;
+            return false;
+        }
+};
+
+/**
+ * @class FileSource
+ * @brief Reads an uncompressed file
+ */
+class FileSource : public ByteSource
+{
+    public:
+        FileSource(const string& filepath) : f(filepath, ios::binary) {}
+
+        bool is_open()
+        {
+            return f.is_open();
+        }
+
+        size_t read(char* dst, size_t n) override
+        {
+            f.read(dst, (streamsize)n);
+            return (size_t)f.gcount();
+        }
+
+        bool seek(uintmax_t offset) override
+        {
+            f.clear();
+            f.seekg((streamoff)offset);
+            return (bool)f;
+        }
+
+    private:
+        ifstream f;
+};
+
+/**
+ * @class DecompressSource
+ * @brief Common part of the decompressing sources
+ *
+ * Holds the compressed input buffer; subclasses run their library's
+ * streaming decoder over it in decode().
+ */
+class DecompressSource : public ByteSource
+{
+    public:
+        DecompressSource(unique_ptr<ByteSource> input) : in(move(input)), inbuf(1 << 18) {}
+
+    protected:
+        unique_ptr<ByteSource> in;
+        vector<char> inbuf;
+        bool in_eof = false;
+        bool failed = false;
+
+        /// Refills inbuf; returns the number of compressed bytes now available.
+        size_t refill()
+        {
+            size_t n = in_eof ? 0 : in->read(inbuf.data(), inbuf.size());
+            if(n == 0) in_eof = true;
+            return n;
+        }
+};
+
+#ifdef CNFSAT_HAVE_LZMA
+/**
+ * @class XzSource
+ * @brief Decodes .xz (and .lzma) streams with liblzma
+ */
+class XzSource : public DecompressSource
+{
+    public:
+        XzSource(unique_ptr<ByteSource> input) : DecompressSource(move(input))
+        {
+            failed = lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK;
+        }
+
+        ~XzSource()
+        {
+            lzma_end(&strm);
+        }
+
+        size_t read(char* dst, size_t n) override
+        {
+            strm.next_out = (uint8_t*)dst;
+            strm.avail_out = n;
+            while(strm.avail_out == n && !failed && !finished)
+            {
+                if(strm.avail_in == 0 && !in_eof)
+                {
+                    strm.avail_in = refill();
+                    strm.next_in = (const uint8_t*)inbuf.data();
+                }
+                lzma_ret ret = lzma_code(&strm, in_eof ? LZMA_FINISH : LZMA_RUN);
+                if(ret == LZMA_STREAM_END) finished = true;
+                else if(ret != LZMA_OK)
+                {
+                    cerr << "xz decompression error " << ret << endl;
+                    failed = true;
+                }
+            }
+            return n - strm.avail_out;
+        }
+
+    private:
+        lzma_stream strm = LZMA_STREAM_INIT;
+        bool finished = false;
+};
+#endif
+
+#ifdef CNFSAT_HAVE_ZLIB
+/**
+ * @class GzSource
+ * @brief Decodes .gz streams (including concatenated members) with zlib
+ */
+class GzSource : public DecompressSource
+{
+    public:
+        GzSource(unique_ptr<ByteSource> input) : DecompressSource(move(input))
+        {
+            memset(&strm, 0, sizeof(strm));
+            failed = inflateInit2(&strm, 15 + 32) != Z_OK;  // +32: expect a gzip header
+        }
+
+        ~GzSource()
+        {
+            inflateEnd(&strm);
+        }
+
+        size_t read(char* dst, size_t n) override
+        {
+            strm.next_out = (Bytef*)dst;
+            strm.avail_out = (uInt)n;
+            while(strm.avail_out == n && !failed)
+            {
+                if(strm.avail_in == 0)
+                {
+                    strm.avail_in = (uInt)refill();
+                    strm.next_in = (Bytef*)inbuf.data();
+                    if(strm.avail_in == 0) break;
+                }
+                int ret = inflate(&strm, Z_NO_FLUSH);
+                if(ret == Z_STREAM_END) inflateReset(&strm);  // another member may follow
+                else if(ret != Z_OK && ret != Z_BUF_ERROR)
+                {
+                    cerr << "gzip decompression error " << ret << endl;
+                    failed = true;
+                }
+            }
+            return n - strm.avail_out;
+        }
+
+    private:
+        z_stream strm;
+};
+#endif
+
+#ifdef CNFSAT_HAVE_BZIP2
+/**
+ * @class Bz2Source
+ * @brief Decodes .bz2 streams (including concatenated ones) with libbzip2
+ */
+class Bz2Source : public DecompressSource
+{
+    public:
+        Bz2Source(unique_ptr<ByteSource> input) : DecompressSource(move(input))
+        {
+            memset(&strm, 0, sizeof(strm));
+            failed = BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK;
+        }
+
+        ~Bz2Source()
+        {
+            BZ2_bzDecompressEnd(&strm);
+        }
+
+        size_t read(char* dst, size_t n) override
+        {
+            strm.next_out = dst;
+            strm.avail_out = (unsigned)n;
+            while(strm.avail_out == n && !failed)
+            {
+                if(strm.avail_in == 0)
+                {
+                    strm.avail_in = (unsigned)refill();
+                    strm.next_in = inbuf.data();
+                    if(strm.avail_in == 0) break;
+                }
+                int ret = BZ2_bzDecompress(&strm);
+                if(ret == BZ_STREAM_END)
+                {
+                    // Restart the decoder on the remaining input for the next stream
+                    char* next_in = strm.next_in;
+                    unsigned avail_in = strm.avail_in;
+                    char* next_out = strm.next_out;
+                    unsigned avail_out = strm.avail_out;
+                    BZ2_bzDecompressEnd(&strm);
+                    memset(&strm, 0, sizeof(strm));
+                    failed = BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK;
+                    strm.next_in = next_in;
+                    strm.avail_in = avail_in;
+                    strm.next_out = next_out;
+                    strm.avail_out = avail_out;
+                }
+                else if(ret != BZ_OK)
+                {
+                    cerr << "bzip2 decompression error " << ret << endl;
+                    failed = true;
+                }
+            }
+            return n - strm.avail_out;
+        }
+
+    private:
+        bz_stream strm;
+};
+#endif
+
+/**
+ * @struct CpuTimes
+ * @brief User and system CPU time in milliseconds
+ */
+struct CpuTimes
+{
+    double user_ms = 0;
+    double sys_ms = 0;
+};
+
+CpuTimes getCpuTimes(bool whole_process);
+void charge_helper_cpu(const CpuTimes& used);
+void adopt_allocation(const void* p);
+
+/**
+ * @class PrefetchSource
+ * @brief Runs another source on its own thread, one block ahead of the reader
+ *
+ * A producer thread keeps up to DECOMPRESS_QUEUE_DEPTH blocks of
+ * DECOMPRESS_BLOCK_SIZE bytes filled from the inner source, so
+ * decompression overlaps with parsing instead of alternating with it.
+ *
+ * The producer's work is charged to the reading thread, so that per-thread
+ * figures (ResourceMeter, Budget) include decompression: each block taken
+ * is adopted into the reader's heap counters, and the producer's CPU time
+ * is added to the reader's helper time as blocks are taken and when the
+ * source is destroyed.
+ */
+class PrefetchSource : public ByteSource
+{
+    public:
+        PrefetchSource(unique_ptr<ByteSource> input) : in(move(input))
+        {
+            producer = thread([this]() { produce(); });
+        }
+
+        ~PrefetchSource()
+        {
+            {
+                lock_guard<mutex> lock(m);
+                stop = true;
+            }
+            cv.notify_all();
+            producer.join();
+
+            // Blocks never read are freed here, on the reading thread
+            for(const vector<char>& block : ready) adopt_allocation(block.data());
+            charge_producer_cpu();
+        }
+
+        size_t read(char* dst, size_t n) override
+        {
+            if(pos == current.size())
+            {
+                unique_lock<mutex> lock(m);
+                cv.wait(lock, [this]() { return !ready.empty() || finished; });
+                if(ready.empty()) return 0;
+                current = move(ready.front());
+                ready.pop_front();
+                pos = 0;
+                charge_producer_cpu();
+                lock.unlock();
+                cv.notify_all();
+                adopt_allocation(current.data());
+            }
+            size_t k = min(n, current.size() - pos);
+            memcpy(dst, current.data() + pos, k);
+            pos += k;
+            return k;
+        }
+
+    private:
+        unique_ptr<ByteSource> in;
+        thread producer;
+        mutex m;
+        condition_variable cv;
+        deque<vector<char>> ready;   ///< Filled blocks waiting for the reader
+        vector<char> current;        ///< Block being handed out by read()
+        size_t pos = 0;
+        bool stop = false;
+        bool finished = false;
+        CpuTimes produced;           ///< CPU time of the producer so far, guarded by m
+        CpuTimes charged;            ///< Part of it already charged to the reader
+
+        /// Charges the producer's CPU time since the last call to the reading thread (m held or producer joined).
+        void charge_producer_cpu()
+        {
+            charge_helper_cpu({produced.user_ms - charged.user_ms, produced.sys_ms - charged.sys_ms});
+            charged = produced;
+        }
+
+        void produce()
+        {
+            CpuTimes start = getCpuTimes(false);
+            while(true)
+            {
+                vector<char> block(DECOMPRESS_BLOCK_SIZE);
+                size_t n = 0;
+                while(n < block.size())
+                {
+                    size_t k = in->read(block.data() + n, block.size() - n);
+                    if(k == 0) break;
+                    n += k;
+                }
+                block.resize(n);
+                CpuTimes now = getCpuTimes(false);
+
+                unique_lock<mutex> lock(m);
+                produced = {now.user_ms - start.user_ms, now.sys_ms - start.sys_ms};
+                cv.wait(lock, [this]() { return ready.size() < DECOMPRESS_QUEUE_DEPTH || stop; });
+                if(stop) return;
+                if(n > 0) ready.push_back(move(block));
+                if(n < DECOMPRESS_BLOCK_SIZE) finished = true;
+                lock.unlock();
+                cv.notify_all();
+                if(n < DECOMPRESS_BLOCK_SIZE) return;
+            }
+        }
+};
+
+/**
+ * @brief Compression formats recognized from a file's magic bytes
+ */
+enum class Compression { None, Xz, Gzip, Bzip2 };
+
+/**
+ * @brief Detects the compression of a stream from its first bytes
+ *
+ * xz starts with FD 37 7A 58 5A 00, gzip with 1F 8B and bzip2 with "BZh".
+ *
+ * @param magic The first bytes of the stream
+ * @param n How many bytes are available (up to 6 are used)
+ */
+Compression detect_compression(const unsigned char* magic, size_t n)
+{
+    if(n >= 6 && memcmp(magic, "\xFD" "7zXZ\0", 6) == 0) return Compression::Xz;
+    if(n >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) return Compression::Gzip;
+    if(n >= 3 && memcmp(magic, "BZh", 3) == 0) return Compression::Bzip2;
+    return Compression::None;
+}
+
+/**
+ * @brief Detects the compression of a file from its magic bytes
+ */
+Compression detect_compression(const string& filepath)
+{
+    unsigned char magic[6] = {0};
+    ifstream f(filepath, ios::binary);
+    f.read((char*)magic, sizeof(magic));
+    return detect_compression(magic, (size_t)f.gcount());
+}
+
+/**
+ * @brief Wraps a raw stream in the decoder for its compression format
+ *
+ * Compressed streams are decoded in memory on a separate thread (see
+ * PrefetchSource); nothing is written to disk.
+ *
+ * @param raw The stream as stored
+ * @param compression Format of @p raw
+ * @param name File name used in the error message
+ * @return unique_ptr<ByteSource> The decoded stream, or nullptr if the
+ *         format is not supported by this build
+ */
+unique_ptr<ByteSource> decompress_source(unique_ptr<ByteSource> raw, Compression compression, const string& name)
+{
+    switch(compression)
+    {
+        case Compression::None:
+            return raw;
+#ifdef CNFSAT_HAVE_LZMA
+        case Compression::Xz:
+            return unique_ptr<ByteSource>(new PrefetchSource(unique_ptr<ByteSource>(new XzSource(move(raw)))));
+#endif
+#ifdef CNFSAT_HAVE_ZLIB
+        case Compression::Gzip:
+            return unique_ptr<ByteSource>(new PrefetchSource(unique_ptr<ByteSource>(new GzSource(move(raw)))));
+#endif
+#ifdef CNFSAT_HAVE_BZIP2
+        case Compression::Bzip2:
+            return unique_ptr<ByteSource>(new PrefetchSource(unique_ptr<ByteSource>(new Bz2Source(move(raw)))));
+#endif
+        default:
+            cerr << "Compressed input is not supported by this build: " << name << endl;
+            return nullptr;
+    }
+}
+
+/**
+ * @brief Opens a CNF file as a byte stream, decompressing it on the fly
+ *
+ * @param filepath Path to a plain, .xz, .gz or .bz2 DIMACS file
+ * @return unique_ptr<ByteSource> The stream, or nullptr if the file cannot be
+ *         opened or its compression is not supported by this build
+ *
+ * @see decompress_source()
+ */
+unique_ptr<ByteSource> open_source(const string& filepath)
+{
+    unique_ptr<FileSource> file(new FileSource(filepath));
+    if(!file->is_open()) return nullptr;
+    return decompress_source(move(file), detect_compression(filepath), filepath);
+}
+
+/**
+ * @class ReplaySource
+ * @brief Returns a few already consumed bytes before continuing with a stream
+ *
+ * Lets the magic bytes of an archive member be inspected without seeking.
+ */
+class ReplaySource : public ByteSource
+{
+    public:
+        ReplaySource(string prefix_bytes, unique_ptr<ByteSource> input) : prefix(move(prefix_bytes)), in(move(input)) {}
+
+        size_t read(char* dst, size_t n) override
+        {
+            if(pos < prefix.size())
+            {
+                size_t k = min(n, prefix.size() - pos);
+                memcpy(dst, prefix.data() + pos, k);
+                pos += k;
+                return k;
+            }
+            return in->read(dst, n);
+        }
+
+    private:
+        string prefix;
+        unique_ptr<ByteSource> in;
+        size_t pos = 0;
+};
+
+/**
+ * @brief Checks from the file name whether a file is a tar archive
+ *
+ * Recognizes .tar and its compressed forms .tar.xz, .txz, .tar.gz, .tgz,
+ * .tar.bz2 and .tbz2.
+ */
+bool is_tar_archive(const string& filepath)
+{
+    string name = fs::path(filepath).filename().string();
+    transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)tolower(c); });
+    for(const char* ext : {".tar", ".tar.xz", ".txz", ".tar.gz", ".tgz", ".tar.bz2", ".tbz2"})
+    {
+        size_t n = strlen(ext);
+        if(name.size() > n && name.compare(name.size() - n, n, ext) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @class TarReader
+ * @brief Walks the members of a tar archive in one sequential pass
+ *
+ * Understands ustar names (prefix + name), GNU long names ('L' entries) and
+ * the path record of pax extended headers ('x' entries). Only regular files
+ * are reported; the unread part of a member is skipped when the next one is
+ * requested, so the archive is never seeked or extracted.
+ */
+class TarReader
+{
+    public:
+        string name;         ///< Path of the current member inside the archive
+        uintmax_t size = 0;  ///< Size of the current member
+
+        /**
+         * @brief Opens a (possibly compressed) archive
+         */
+        TarReader(const string& filepath) : src(open_source(filepath)) {}
+
+        bool is_open()
+        {
+            return src != nullptr;
+        }
+
+        /**
+         * @brief Advances to the next regular file
+         * @return bool False at the end of the archive or on a damaged header
+         */
+        bool next_member()
+        {
+            string long_name;
+            while(true)
+            {
+                if(!skip(left + padding(size))) return false;
+                left = 0;
+
+                char h[512];
+                if(!read_exact(h, 512)) return false;
+                if(h[0] == '\0') return false;  // end-of-archive block
+
+                size = parse_size(h + 124);
+                char type = h[156];
+                left = size;
+
+                if(type == 'L' || type == 'x')
+                {
+                    string data(size, '\0');
+                    if(!read_exact(&data[0], size)) return false;
+                    left = 0;
+                    long_name = (type == 'L') ? string(data.c_str()) : pax_path(data);
+                    continue;
+                }
+                if(type != '0' && type != '\0')
+                {
+                    long_name.clear();  // directory, link or global header
+                    continue;
+                }
+
+                if(!long_name.empty())
+                {
+                    name = long_name;
+                }
+                else
+                {
+                    string base(h, strnlen(h, 100));
+                    string prefix = (memcmp(h + 257, "ustar", 5) == 0) ? string(h + 345, strnlen(h + 345, 155)) : "";
+                    name = prefix.empty() ? base : prefix + "/" + base;
+                }
+                return true;
+            }
+        }
+
+        /**
+         * @brief Opens the current member as a stream, decompressing it if needed
+         * @return unique_ptr<ByteSource> Stream valid until next_member() is called
+         */
+        unique_ptr<ByteSource> open_member()
+        {
+            unique_ptr<ByteSource> member(new MemberSource(this));
+            char magic[6];
+            size_t n = member->read(magic, sizeof(magic));
+            Compression compression = detect_compression((const unsigned char*)magic, n);
+            unique_ptr<ByteSource> replay(new ReplaySource(string(magic, n), move(member)));
+            return decompress_source(move(replay), compression, name);
+        }
+
+    private:
+        /**
+         * @class MemberSource
+         * @brief Stream limited to the bytes of the current member
+         */
+        class MemberSource : public ByteSource
+        {
+            public:
+                MemberSource(TarReader* archive) : tar(archive) {}
+
+                size_t read(char* dst, size_t n) override
+                {
+                    size_t k = (size_t)min<uintmax_t>(n, tar->left);
+                    if(k == 0) return 0;
+                    k = tar->src->read(dst, k);
+                    tar->left -= k;
+                    return k;
+                }
+
+            private:
+                TarReader* tar;
+        };
+
+        unique_ptr<ByteSource> src;
+        uintmax_t left = 0;   ///< Unread bytes of the current member
+
+        static uintmax_t padding(uintmax_t n)
+        {
+            return (512 - n % 512) % 512;
+        }
+
+        /// Member sizes are octal, or base-256 when the top bit is set.
+        static uintmax_t parse_size(const char* field)
+        {
+            uintmax_t v = 0;
+            if((unsigned char)field[0] & 0x80)
+            {
+                for(int k = 1; k < 12; k++) v = (v << 8) | (unsigned char)field[k];
+                return v;
+            }
+            for(int k = 0; k < 12 && field[k]; k++)
+            {
+                if(field[k] >= '0' && field[k] <= '7') v = v*8 + (field[k] - '0');
+            }
+            return v;
+        }
+
+        /// Extracts "path" from pax records of the form "<len> path=<value>\n".
+        static string pax_path(const string& data)
+        {
+            size_t pos = 0;
+            while(pos < data.size())
+            {
+                size_t space = data.find(' ', pos);
+                if(space == string::npos) break;
+                // "<length> <key>=<value>\n", the length counting the whole record
+                string digits = data.substr(pos, space - pos);
+                char* end;
+                unsigned long len = strtoul(digits.c_str(), &end, 10);
+                if(digits.empty() || *end != '\0' || digits[0] < '0' || digits[0] > '9') break;
+                if(len < space - pos + 2 || len > data.size() - pos) break;
+                string record = data.substr(space + 1, pos + len - space - 2);
+                if(record.compare(0, 5, "path=") == 0) return record.substr(5);
+                pos += len;
+            }
+            return "";
+        }
+
+        bool read_exact(char* dst, uintmax_t n)
+        {
+            while(n > 0)
+            {
+                size_t k = src->read(dst, (size_t)n);
+                if(k == 0) return false;
+                dst += k;
+                n -= k;
+            }
+            return true;
+        }
+
+        bool skip(uintmax_t n)
+        {
+            char scratch[1 << 14];
+            while(n > 0)
+            {
+                size_t k = src->read(scratch, (size_t)min<uintmax_t>(n, sizeof(scratch)));
+                if(k == 0) return false;
+                n -= k;
+            }
+            return true;
+        }
+};
+
+/**
+ * @class DimacsReader
+ * @brief Reads a DIMACS CNF file in large chunks and decodes its literals
+ *
+ * The input comes from open_source(), so .xz, .gz and .bz2 files are read
+ * directly. The header lines and the clause body share one buffer; the body
+ * is handed to the parser in DIMACS_CHUNK_SIZE blocks that are cut at a line
+ * boundary (the remainder is carried into the next block), so clauses may
+ * span lines and no per-line string or stream objects are created.
+ */
+class DimacsReader
+{
+    public:
+        int var_no = 0;     ///< Number of variables from the header
+        int clause_no = 0;  ///< Number of clauses from the header
+
+        /**
+         * @brief Opens the file for reading
+         * @param filepath Path to the CNF file in DIMACS format, optionally compressed
+         */
+        DimacsReader(const string& filepath) : src(open_source(filepath))
+        {
+            buf.resize(DIMACS_CHUNK_SIZE + DIMACS_PADDING);
+        }
+
+        /**
+         * @brief Reads from an already opened stream, such as an archive member
+         * @param source The DIMACS text; nullptr makes is_open() fail
+         */
+        DimacsReader(unique_ptr<ByteSource> source) : src(move(source))
+        {
+            buf.resize(DIMACS_CHUNK_SIZE + DIMACS_PADDING);
+        }
+
+        /**
+         * @brief Checks whether the file could be opened
+         */
+        bool is_open()
+        {
+            return src != nullptr;
+        }
+
+        /**
+         * @brief Skips comments and parses the problem line: p cnf <variables> <clauses>
+         * @return bool False if no well-formed problem line was found
+         */
+        bool read_header()
+        {
+            string line;
+            while(next_line(line))
+            {
+                if(!line.empty() && line[0] == 'p')
+                {
+                    stringstream ss(line);
+                    string p, cnf;
+                    ss >> p >> cnf >> var_no >> clause_no;
+                    return !ss.fail();
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Decodes the next chunk of the clause body
+         * @param lits Cleared, then filled with literals; 0 marks the end of a clause
+         * @return bool False when the whole body has been consumed
+         */
+        bool next_literals(vector<int>& lits)
+        {
+            lits.clear();
+            while(lits.empty())
+            {
+                size_t n = fill();
+                if(n == 0) return false;
+                if(!parse(buf.data(), buf.data() + n, lits)) done = end_marker = true;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Offset in the (decompressed) input of the first byte after the problem line
+         *
+         * Only meaningful right after read_header().
+         */
+        uintmax_t body_offset()
+        {
+            return buf_offset + start;
+        }
+
+        /**
+         * @brief Restricts reading of the clause body to the byte range [begin, end)
+         *
+         * Used to parse one slice of a large file; @p begin must be a clause
+         * boundary (see next_clause_boundary()).
+         *
+         * @return bool False for compressed input, which cannot seek
+         */
+        bool seek_range(uintmax_t begin, uintmax_t end)
+        {
+            if(!src->seek(begin)) return false;
+            buf_offset = begin;
+            used = start = 0;
+            done = end_marker = false;
+            remaining = end - begin;
+            return true;
+        }
+
+        /**
+         * @brief Whether parsing stopped at a '%' end marker
+         */
+        bool at_end_marker()
+        {
+            return end_marker;
+        }
+
+    private:
+        unique_ptr<ByteSource> src;
+        vector<char> buf;
+        uintmax_t buf_offset = 0;  ///< Input offset of buf[0]
+        size_t used = 0;     ///< Bytes currently held in buf
+        size_t start = 0;    ///< First byte of buf not yet handed out
+        bool done = false;   ///< End of input or '%' marker reached
+        bool end_marker = false;
+        uintmax_t remaining = UINTMAX_MAX;  ///< Bytes left in the range being read
+        LiteralParser parse = select_literal_parser();
+
+        /**
+         * @brief Moves the unread tail of buf to the front and reads more input
+         * @return size_t Number of new bytes; 0 at the end of the input
+         */
+        size_t read_more()
+        {
+            memmove(buf.data(), buf.data() + start, used - start);
+            buf_offset += start;
+            used -= start;
+            start = 0;
+            if(used == buf.size() - DIMACS_PADDING) buf.resize(buf.size()*2);  // A single token or line longer than the buffer
+            if(remaining == 0) return 0;
+
+            size_t capacity = buf.size() - DIMACS_PADDING;
+            size_t n = src->read(buf.data() + used, (size_t)min<uintmax_t>(capacity - used, remaining));
+            used += n;
+            remaining -= n;
+            return n;
+        }
+
+        /**
+         * @brief Hands out the next line of the input (used for the header)
+         */
+        bool next_line(string& line)
+        {
+            char* nl;
+            while((nl = (char*)memchr(buf.data() + start, '\n', used - start)) == nullptr)
+            {
+                if(read_more() == 0) break;
+            }
+            size_t end = nl ? nl - buf.data() : used;
+            if(nl == nullptr && end == start) return false;
+
+            line.assign(buf.data() + start, end - start);
+            if(!line.empty() && line.back() == '\r') line.pop_back();
+            start = nl ? end + 1 : end;
+            return true;
+        }
+
+        /**
+         * @brief Refills buf and returns how many leading bytes form whole lines
+         */
+        size_t fill()
+        {
+            if(done) return 0;
+
+            while(true)
+            {
+                size_t n = read_more();
+
+                if(n == 0)
+                {
+                    done = true;
+                    memset(buf.data() + used, '\n', DIMACS_PADDING);
+                    start = used;
+                    return used;
+                }
+
+                // Cut after the last newline, or at least at some whitespace
+                size_t cut = used;
+                while(cut > 0 && buf[cut-1] != '\n') cut--;
+                if(cut == 0)
+                {
+                    cut = used;
+                    while(cut > 0 && buf[cut-1] != ' ' && buf[cut-1] != '\t' && buf[cut-1] != '\r') cut--;
+                }
+                if(cut > 0)
+                {
+                    start = cut;
+                    return cut;
+                }
+            }
+        }
+};
+
+/**
+ * @struct HeapCounters
+ * @brief Heap usage of one thread, kept up to date by operator new/delete
+ */
+struct HeapCounters
+{
+    int64_t live = 0;         ///< Bytes currently allocated by this thread
+    int64_t peak = 0;         ///< Highest value of live since the last reset
+    uint64_t allocated = 0;   ///< Total bytes ever allocated by this thread
+};
+
+/// Heap usage of the calling thread.
+thread_local HeapCounters thread_heap;
+
+/// Heap usage of the whole process, for analyses that span several threads.
+atomic<int64_t> process_heap_live(0);
+atomic<int64_t> process_heap_peak(0);
+atomic<uint64_t> process_heap_allocated(0);
+
+/**
+ * @brief Usable size of a block returned by malloc()
+ */
+inline size_t allocation_size(void* p)
+{
+#if defined(_WIN32)
+    return _msize(p);
+#elif defined(__APPLE__)
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+/**
+ * @brief Adds a new heap block to the thread and process counters
+ */
+inline void record_alloc(size_t n)
+{
+    thread_heap.live += n;
+    thread_heap.allocated += n;
+    if(thread_heap.live > thread_heap.peak) thread_heap.peak = thread_heap.live;
+
+    process_heap_allocated.fetch_add(n, memory_order_relaxed);
+    int64_t live = process_heap_live.fetch_add(n, memory_order_relaxed) + n;
+    int64_t peak = process_heap_peak.load(memory_order_relaxed);
+    while(live > peak && !process_heap_peak.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+}
+
+/**
+ * @brief Removes a freed heap block from the thread and process counters
+ */
+inline void record_free(size_t n)
+{
+    thread_heap.live -= n;
+    process_heap_live.fetch_sub(n, memory_order_relaxed);
+}
+
+/**
+ * @brief Moves a heap block allocated by another thread onto the calling thread's counters
+ *
+ * For blocks handed over between threads (see PrefetchSource): the block
+ * is counted as if the calling thread had allocated it, so freeing it here
+ * does not drive the thread's live count negative. The process counters
+ * already include it.
+ */
+void adopt_allocation(const void* p)
+{
+    if(p == nullptr) return;
+    size_t n = allocation_size(const_cast<void*>(p));
+    thread_heap.live += n;
+    thread_heap.allocated += n;
+    if(thread_heap.live > thread_heap.peak) thread_heap.peak = thread_heap.live;
+}
+
+/**
+ * @brief Global allocation functions that keep HeapCounters up to date
+ *
+ * Every C++ allocation of the program goes through these, so the bytes a
+ * file's analysis allocates can be attributed to the thread that analyzed
+ * it even while other files are processed in parallel. Memory that C
+ * libraries (liblzma, zlib, libbzip2) allocate with malloc() directly is not
+ * counted.
+ */
+void* operator new(size_t n)
+{
+    void* p = malloc(n ? n : 1);
+    if(p == nullptr) throw bad_alloc();
+    record_alloc(allocation_size(p));
+    return p;
+}
+
+void* operator new[](size_t n)
+{
+    return operator new(n);
+}
+
+void* operator new(size_t n, const nothrow_t&) noexcept
+{
+    void* p = malloc(n ? n : 1);
+    if(p != nullptr) record_alloc(allocation_size(p));
+    return p;
+}
+
+void* operator new[](size_t n, const nothrow_t& tag) noexcept
+{
+    return operator new(n, tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    if(p == nullptr) return;
+    record_free(allocation_size(p));
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept
+{
+    operator delete(p);
+}
+
+/**
+ * @struct Limits
+ * @brief Per-file resource limits; zero means unlimited
+ */
+struct Limits
+{
+    double time_s = 0;        ///< Wall-clock seconds allowed for one file
+    size_t memory_mb = 0;     ///< Heap megabytes one file's analysis may hold
+};
+
+/**
+ * @class Budget
+ * @brief Enforces Limits on one running analysis
+ *
+ * The analysis loops call exceeded() between chunks; once a limit has been
+ * hit it keeps returning true, so every thread of a split file stops. Heap
+ * use is measured like ResourceMeter does: for the calling thread, or for
+ * the whole process when the analysis spans several threads.
+ */
+class Budget
+{
+    public:
+        Budget(const Limits& limits, bool whole_process) :
+            timed(limits.time_s > 0), memory_limit((int64_t)limits.memory_mb << 20), process(whole_process)
+        {
+            deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                           chrono::duration<double>(limits.time_s));
+            base_live = process ? process_heap_live.load() : thread_heap.live;
+        }
+
+        /**
+         * @brief Checks the limits
+         * @return bool True if the analysis must stop
+         */
+        bool exceeded()
+        {
+            if(state.load(memory_order_relaxed) != 0) return true;
+            if(timed && chrono::steady_clock::now() > deadline)
+            {
+                state = 1;
+                return true;
+            }
+            int64_t live = process ? process_heap_live.load(memory_order_relaxed) : thread_heap.live;
+            if(memory_limit > 0 && live - base_live > memory_limit)
+            {
+                state = 2;
+                return true;
+            }
+            return false;
+        }
+
+        /// "TIMEOUT" or "MEMOUT" once a limit was hit, "" otherwise.
+        string outcome() const
+        {
+            int s = state.load();
+            return s == 1 ? "TIMEOUT" : s == 2 ? "MEMOUT" : "";
+        }
+
+    private:
+        bool timed;
+        chrono::steady_clock::time_point deadline;
+        int64_t memory_limit;
+        bool process;
+        int64_t base_live;
+        atomic<int> state{0};
+};
+
+/// Above this many variables the dense stamp table is replaced by sorting.
+const int DENSE_STAMP_MAX_VARS = 1 << 24;
+
+/**
+ * @class TautologyDetector
+ * @brief Finds clauses that contain both a literal and its negation
+ *
+ * For the usual variable counts it keeps one stamp per literal (2*var_no
+ * entries). Adding a literal writes the current clause id into its slot, and
+ * the complement check is a single load comparing against that id, so
+ * nothing is cleared or hashed between clauses. When the header announces
+ * more than DENSE_STAMP_MAX_VARS variables the clause is buffered instead
+ * and checked by sorting it. Literals beyond the header's var_no are
+ * buffered and sorted the same way, so a stray huge literal never grows
+ * the table; x and -x always land on the same side.
+ */
+class TautologyDetector
+{
+    public:
+        /**
+         * @brief Sizes the stamp table from the header
+         * @param var_no Number of variables declared in the problem line
+         */
+        TautologyDetector(int var_no)
+        {
+            dense = var_no <= DENSE_STAMP_MAX_VARS;
+            if(dense) stamp.assign(2*(size_t)max(var_no,0) + 2, 0);
+        }
+
+        /**
+         * @brief Records one literal of the current clause
+         * @param lit Non-zero DIMACS literal
+         */
+        void add(int lit)
+        {
+            if(!dense)
+            {
+                clause.push_back(lit);
+                return;
+            }
+            size_t idx = index(lit);
+            if(idx >= stamp.size())
+            {
+                clause.push_back(lit);  // literal beyond the header's var_no
+                return;
+            }
+            if(stamp[idx ^ 1] == clause_id) tautology = true;
+            stamp[idx] = clause_id;
+        }
+
+        /**
+         * @brief Closes the current clause and starts the next one
+         * @return bool True if the clause contained some x and -x
+         */
+        bool end_clause()
+        {
+            bool ans = tautology;
+            tautology = false;
+
+            if(!clause.empty())
+            {
+                // Sorting by variable puts x and -x next to each other
+                sort(clause.begin(), clause.end(), [](int a, int b) { return abs(a) < abs(b) || (abs(a) == abs(b) && a < b); });
+                for(size_t k = 1; k < clause.size() && !ans; k++)
+                {
+                    if(clause[k] == -clause[k-1]) ans = true;
+                }
+                clause.clear();
+            }
+            if(!dense) return ans;
+
+            if(++clause_id == 0)
+            {
+                // Ids wrapped around after 2^32 clauses
+                fill(stamp.begin(), stamp.end(), 0);
+                clause_id = 1;
+            }
+            return ans;
+        }
+
+    private:
+        bool dense;
+        bool tautology = false;
+        uint32_t clause_id = 1;   ///< Stamp value meaning "seen in the current clause"
+        vector<uint32_t> stamp;   ///< Last clause id per literal, 2*v for v and 2*v+1 for -v
+        vector<int> clause;       ///< Current clause (or its literals beyond the table) when sorting instead of stamping
+
+        static size_t index(int lit)
+        {
+            return lit > 0 ? 2*(size_t)lit : 2*(size_t)(-(int64_t)lit) + 1;
+        }
+};
+
+/**
+ * @brief Counts the valid clauses in the rest of a literal stream
+ *
+ * @param reader Reader positioned at the clause body (after read_header()
+ *               or seek_range())
+ * @param var_no Number of variables, used to size the TautologyDetector
+ * @param budget Limits checked once per chunk, or nullptr for none
+ * @return int Number of valid clauses found (so far, if the budget ran out)
+ */
+int count_valid_clauses(DimacsReader& reader, int var_no, Budget* budget = nullptr)
+{
+    int valid_clause_no = 0;
+    TautologyDetector detector(var_no);
+    vector<int> lits;
+
+    // Process the literal stream chunk by chunk
+    while(!(budget && budget->exceeded()) && reader.next_literals(lits))
+    {
+        for(int no : lits)
+        {
+            if(no==0)  // 0 marks end of clause
+            {
+                if(detector.end_clause()) valid_clause_no++;
+            }
+            else
+            {
+                detector.add(no);
+            }
+        }
+    }
+    return valid_clause_no;
+}
+
+/**
+ * @struct ArenaView
+ * @brief Read-only view of a formula stored as a ClauseArena
+ *
+ * The arrays may belong to a ClauseArena or to a memory-mapped sidecar file
+ * (see MappedArena); the analyses work on either without copying.
+ */
+struct ArenaView
+{
+    int var_no = 0;
+    int clause_no = 0;
+    const int32_t* lits = nullptr;
+    const uint64_t* offsets = nullptr;
+    size_t n_lits = 0;
+    size_t n_clauses = 0;
+
+    size_t size() const
+    {
+        return n_clauses;
+    }
+
+    const int32_t* begin(size_t c) const
+    {
+        return lits + offsets[c];
+    }
+
+    const int32_t* end(size_t c) const
+    {
+        return lits + offsets[c+1];
+    }
+
+    size_t length(size_t c) const
+    {
+        return (size_t)(offsets[c+1] - offsets[c]);
+    }
+};
+
+/**
+ * @class ClauseArena
+ * @brief A whole CNF formula held in two flat arrays
+ *
+ * The literals of all clauses are stored back to back in one int32 array
+ * (without the terminating zeros), and clause i occupies
+ * lits[offsets[i]] .. lits[offsets[i+1]-1]. Scanning the formula is then a
+ * linear walk over contiguous memory, and questions after the first one do
+ * not parse the file again.
+ */
+class ClauseArena
+{
+    public:
+        int var_no = 0;             ///< Number of variables from the header
+        int clause_no = 0;          ///< Number of clauses from the header
+        vector<int32_t> lits;       ///< All literals, clause after clause
+        vector<uint64_t> offsets{0};///< Start of every clause, plus the end of the last
+
+        /// Number of clauses stored.
+        size_t size() const
+        {
+            return offsets.size() - 1;
+        }
+
+        const int32_t* begin(size_t c) const
+        {
+            return lits.data() + offsets[c];
+        }
+
+        const int32_t* end(size_t c) const
+        {
+            return lits.data() + offsets[c+1];
+        }
+
+        size_t length(size_t c) const
+        {
+            return (size_t)(offsets[c+1] - offsets[c]);
+        }
+
+        /// Appends one clause.
+        void add_clause(const int32_t* first, const int32_t* last)
+        {
+            lits.insert(lits.end(), first, last);
+            offsets.push_back(lits.size());
+        }
+
+        void clear()
+        {
+            lits.clear();
+            offsets.assign(1, 0);
+        }
+
+        /// The analyses take an ArenaView, so an arena can be passed directly.
+        operator ArenaView() const
+        {
+            ArenaView v;
+            v.var_no = var_no;
+            v.clause_no = clause_no;
+            v.lits = lits.data();
+            v.offsets = offsets.data();
+            v.n_lits = lits.size();
+            v.n_clauses = size();
+            return v;
+        }
+};
+
+/**
+ * @brief Loads the rest of a DIMACS stream into a ClauseArena
+ *
+ * The offset array is reserved for the clause count of the header and the
+ * literal array for that count times the mean clause length of the first
+ * chunk, so both are normally allocated once. A last clause without its
+ * terminating 0 is dropped, as the counting functions ignore it too.
+ *
+ * @param reader Reader positioned at the clause body (after read_header())
+ * @param arena Receives the formula; var_no and clause_no come from the reader
+ * @param size_hint Size of the input in bytes, used to bound the reservation
+ *                  when the header overstates the clause count (0 if unknown)
+ * @param budget Limits checked once per chunk, or nullptr for none
+ * @return bool False if the budget ran out before the end of the input
+ */
+bool load_arena(DimacsReader& reader, ClauseArena& arena, uintmax_t size_hint = 0, Budget* budget = nullptr)
+{
+    arena.clear();
+    arena.var_no = reader.var_no;
+    arena.clause_no = reader.clause_no;
+
+    // Every clause takes at least two bytes ("0 "), which caps the reservation
+    uintmax_t clauses = (uintmax_t)max(reader.clause_no, 0);
+    uintmax_t cap = size_hint > 0 ? size_hint / 2 + 1 : (uintmax_t)1 << 26;
+    arena.offsets.reserve((size_t)min(clauses, cap) + 1);
+
+    vector<int> chunk;
+    size_t clause_start = 0;
+    bool first = true;
+    while(reader.next_literals(chunk))
+    {
+        if(budget && budget->exceeded()) return false;
+        for(int lit : chunk)
+        {
+            if(lit == 0)
+            {
+                arena.offsets.push_back(arena.lits.size());
+                clause_start = arena.lits.size();
+            }
+            else
+            {
+                arena.lits.push_back(lit);
+            }
+        }
+        if(first && arena.size() > 0)
+        {
+            double mean = (double)arena.offsets.back() / arena.size();
+            uintmax_t estimate = (uintmax_t)(mean * min(clauses, cap)) + 1;
+            if(size_hint > 0) estimate = min(estimate, size_hint / 2 + 1);
+            arena.lits.reserve((size_t)max<uintmax_t>(estimate, arena.lits.size()));
+            first = false;
+        }
+    }
+    arena.lits.resize(clause_start);
+    return true;
+}
+
+/**
+ * @brief Loads a DIMACS file, optionally compressed, into a ClauseArena
+ * @return bool False if the file cannot be opened or has no problem line
+ */
+bool load_arena(const string& filepath, ClauseArena& arena)
+{
+    DimacsReader reader(filepath);
+    if(!reader.is_open() || !reader.read_header()) return false;
+
+    error_code ec;
+    uintmax_t size = detect_compression(filepath) == Compression::None ? fs::file_size(filepath, ec) : 0;
+    return load_arena(reader, arena, ec ? 0 : size);
+}
+
+/**
+ * @brief Counts the valid (tautological) clauses among clauses [first, last) of a loaded formula
+ *
+ * @param budget Limits checked every 64K clauses, or nullptr for none
+ */
+int count_valid_clauses(const ArenaView& arena, size_t first, size_t last, Budget* budget = nullptr)
+{
+    int valid_clause_no = 0;
+    TautologyDetector detector(arena.var_no);
+    for(size_t c = first; c < last; c++)
+    {
+        if((c & 0xFFFF) == 0 && budget && budget->exceeded()) break;
+        for(const int32_t* p = arena.begin(c); p != arena.end(c); p++) detector.add(*p);
+        if(detector.end_clause()) valid_clause_no++;
+    }
+    return valid_clause_no;
+}
+
+/**
+ * @brief Counts the valid (tautological) clauses of a loaded formula
+ */
+int count_valid_clauses(const ArenaView& arena)
+{
+    return count_valid_clauses(arena, 0, arena.size());
+}
+
+/**
+ * @struct CnfStats
+ * @brief Size and shape statistics of a formula
+ */
+struct CnfStats
+{
+    size_t clauses = 0;
+    size_t literals = 0;
+    size_t empty = 0;          ///< Clauses with no literal
+    size_t units = 0;          ///< Clauses with one literal
+    size_t binary = 0;         ///< Clauses with two literals
+    size_t ternary = 0;        ///< Clauses with three literals
+    size_t max_length = 0;     ///< Longest clause
+    int vars_used = 0;         ///< Variables that occur at least once
+    int max_var = 0;           ///< Largest variable index that occurs
+};
+
+/**
+ * @brief Computes CnfStats in one pass over a loaded formula
+ */
+CnfStats cnf_stats(const ArenaView& arena)
+{
+    CnfStats s;
+    s.clauses = arena.size();
+    s.literals = arena.n_lits;
+
+    vector<char> seen((size_t)max(arena.var_no, 0) + 1, 0);
+    vector<int> beyond;  // variables beyond the header's var_no, deduplicated at the end
+    for(size_t c = 0; c < arena.size(); c++)
+    {
+        size_t len = arena.length(c);
+        if(len == 0) s.empty++;
+        else if(len == 1) s.units++;
+        else if(len == 2) s.binary++;
+        else if(len == 3) s.ternary++;
+        s.max_length = max(s.max_length, len);
+    }
+    for(size_t k = 0; k < arena.n_lits; k++)
+    {
+        int32_t lit = arena.lits[k];
+        size_t v = (size_t)abs((int64_t)lit);
+        if(v >= seen.size()) beyond.push_back((int)v);
+        else if(!seen[v])
+        {
+            seen[v] = 1;
+            s.vars_used++;
+        }
+        s.max_var = max(s.max_var, (int)v);
+    }
+    sort(beyond.begin(), beyond.end());
+    s.vars_used += (int)(unique(beyond.begin(), beyond.end()) - beyond.begin());
+    return s;
+}
+
+/// Starting value of hash_bytes().
+const uint64_t HASH_SEED = 0x243F6A8885A308D3ull;
+
+/**
+ * @brief Folds a block of bytes into a running 64-bit hash
+ *
+ * Mixes 8 bytes per step with a multiply and rotate. Calls may be chained
+ * over consecutive blocks as long as every block but the last has a size
+ * that is a multiple of 8. Not for security.
+ */
+uint64_t hash_bytes(uint64_t h, const void* data, size_t n)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    size_t k = 0;
+    for(; k + 8 <= n; k += 8)
+    {
+        uint64_t w;
+        memcpy(&w, p + k, 8);
+        h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+        h = (h << 31) | (h >> 33);
+    }
+    for(; k < n; k++) h = (h ^ p[k]) * 0x100000001B3ull;
+    return h;
+}
+
+/**
+ * @brief Final avalanche step of hash_bytes()
+ * @param total Number of bytes hashed
+ */
+uint64_t hash_finish(uint64_t h, uint64_t total)
+{
+    h ^= total;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Modification time of a file as a plain number, or 0 if unknown
+ */
+long long file_mtime(const string& file)
+{
+    error_code ec;
+    auto t = fs::last_write_time(file, ec);
+    return ec ? 0 : (long long)t.time_since_epoch().count();
+}
+
+/// File name suffix of the binary sidecar of a DIMACS file.
+const char* SIDECAR_SUFFIX = ".arena";
+
+/// Version of the sidecar layout; files of another version are ignored.
+const uint32_t SIDECAR_VERSION = 1;
+
+/**
+ * @struct SidecarHeader
+ * @brief First bytes of a binary sidecar file
+ *
+ * The header is followed by n_lits int32 literals and, at the next multiple
+ * of 8 bytes, n_clauses+1 uint64 offsets: the arrays of a ClauseArena as
+ * they are in memory, so a mapped file can be used without decoding. The
+ * size and mtime of the DIMACS file the sidecar was made from tell whether
+ * it is still fresh, and the checksum covers both arrays.
+ */
+struct SidecarHeader
+{
+    char magic[8];            ///< "CNFARENA"
+    uint32_t version;         ///< SIDECAR_VERSION
+    uint32_t byte_order;      ///< 0x01020304 in the writer's byte order
+    int32_t var_no;           ///< Header of the DIMACS file
+    int32_t clause_no;
+    uint64_t n_clauses;       ///< Clauses stored
+    uint64_t n_lits;          ///< Literals stored
+    uint64_t source_size;     ///< Size of the DIMACS file
+    int64_t source_mtime;     ///< Modification time of the DIMACS file (see file_mtime())
+    uint64_t checksum;        ///< hash_bytes() over the literal and offset arrays
+    uint64_t reserved;
+};
+
+/**
+ * @brief Byte offset of the offset array in a sidecar
+ */
+inline uint64_t sidecar_offsets_at(uint64_t n_lits)
+{
+    return (sizeof(SidecarHeader) + n_lits * sizeof(int32_t) + 7) / 8 * 8;
+}
+
+/**
+ * @brief Checksum of the arrays of a formula as stored in a sidecar
+ */
+uint64_t arena_checksum(const ArenaView& arena)
+{
+    uint64_t lit_bytes = arena.n_lits * sizeof(int32_t);
+    uint64_t off_bytes = (arena.n_clauses + 1) * sizeof(uint64_t);
+    uint64_t h = hash_bytes(HASH_SEED, arena.lits, lit_bytes / 8 * 8);
+    h = hash_bytes(h, (const char*)arena.lits + lit_bytes / 8 * 8, lit_bytes % 8);  // at most one literal
+    h = hash_bytes(h, arena.offsets, off_bytes);
+    return hash_finish(h, lit_bytes + off_bytes);
+}
+
+/**
+ * @brief Writes a loaded formula as the binary sidecar of a DIMACS file
+ *
+ * The file is written under a temporary name and renamed into place, so a
+ * reader never maps a half-written sidecar.
+ *
+ * @param arena The formula, loaded from @p source
+ * @param source_size Size of the DIMACS file when it was loaded
+ * @param source_mtime Its modification time when it was loaded
+ * @param out Path of the sidecar
+ * @return bool False if the file cannot be written
+ */
+bool write_sidecar(const ClauseArena& arena, uint64_t source_size, long long source_mtime, const string& out)
+{
+    SidecarHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CNFARENA", 8);
+    h.version = SIDECAR_VERSION;
+    h.byte_order = 0x01020304;
+    h.var_no = arena.var_no;
+    h.clause_no = arena.clause_no;
+    h.n_clauses = arena.size();
+    h.n_lits = arena.lits.size();
+    h.source_size = source_size;
+    h.source_mtime = source_mtime;
+    h.checksum = arena_checksum(arena);
+
+    string tmp = out + ".tmp";
+    {
+        ofstream f(tmp, ios::binary);
+        if(!f) return false;
+        f.write((const char*)&h, sizeof(h));
+        f.write((const char*)arena.lits.data(), arena.lits.size() * sizeof(int32_t));
+        static const char zeros[8] = {0};
+        uint64_t pad = sidecar_offsets_at(h.n_lits) - sizeof(h) - h.n_lits * sizeof(int32_t);
+        f.write(zeros, pad);
+        f.write((const char*)arena.offsets.data(), arena.offsets.size() * sizeof(uint64_t));
+        if(!f) return false;
+    }
+    error_code ec;
+    fs::rename(tmp, out, ec);
+    return !ec;
+}
+
+/**
+ * @class MappedArena
+ * @brief A binary sidecar mapped into memory read-only
+ *
+ * Opening validates the header, the file size and the checksum; the
+ * formula is then used in place through view(), with no parsing and no
+ * copy. Uses mmap() on POSIX systems and a file mapping on Windows.
+ */
+class MappedArena
+{
+    public:
+        MappedArena() = default;
+        MappedArena(const MappedArena&) = delete;
+        MappedArena& operator=(const MappedArena&) = delete;
+
+        ~MappedArena()
+        {
+            close();
+        }
+
+        /**
+         * @brief Maps and validates a sidecar
+         * @return bool False if the file is missing, truncated, of another
+         *              version or byte order, or fails its checksum
+         */
+        bool open(const string& path)
+        {
+            close();
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if(file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            if(!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(SidecarHeader)) return fail();
+            bytes = (uint64_t)size.QuadPart;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping == nullptr) return fail();
+            data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if(data == nullptr) return fail();
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if(fd < 0) return false;
+            struct stat st;
+            if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SidecarHeader))
+            {
+                ::close(fd);
+                return false;
+            }
+            bytes = (uint64_t)st.st_size;
+            void* p = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if(p == MAP_FAILED) return false;
+            data = (const char*)p;
+#ifdef MADV_SEQUENTIAL
+            madvise(p, bytes, MADV_SEQUENTIAL);
+#endif
+#endif
+            return validate() || fail();
+        }
+
+        const SidecarHeader& header() const
+        {
+            return *(const SidecarHeader*)data;
+        }
+
+        ArenaView view() const
+        {
+            const SidecarHeader& h = header();
+            ArenaView v;
+            v.var_no = h.var_no;
+            v.clause_no = h.clause_no;
+            v.lits = (const int32_t*)(data + sizeof(SidecarHeader));
+            v.offsets = (const uint64_t*)(data + sidecar_offsets_at(h.n_lits));
+            v.n_lits = (size_t)h.n_lits;
+            v.n_clauses = (size_t)h.n_clauses;
+            return v;
+        }
+
+        void close()
+        {
+#ifdef _WIN32
+            if(data) UnmapViewOfFile(data);
+            if(mapping) CloseHandle(mapping);
+            if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if(data) munmap((void*)data, bytes);
+#endif
+            data = nullptr;
+            bytes = 0;
+        }
+
+    private:
+        const char* data = nullptr;
+        uint64_t bytes = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+        bool fail()
+        {
+            close();
+            return false;
+        }
+
+        bool validate()
+        {
+            const SidecarHeader& h = header();
+            if(memcmp(h.magic, "CNFARENA", 8) != 0 || h.version != SIDECAR_VERSION || h.byte_order != 0x01020304) return false;
+            if(h.n_lits > bytes / sizeof(int32_t) || h.n_clauses > bytes / sizeof(uint64_t)) return false;
+            if(bytes != sidecar_offsets_at(h.n_lits) + (h.n_clauses + 1) * sizeof(uint64_t)) return false;
+
+            ArenaView v = view();
+            if(v.offsets[0] != 0 || v.offsets[v.n_clauses] != h.n_lits) return false;
+            return arena_checksum(v) == h.checksum;
+        }
+};
+
+/**
+ * @brief Path of the binary sidecar of a DIMACS file
+ */
+string sidecar_path(const string& filepath)
+{
+    return filepath + SIDECAR_SUFFIX;
+}
+
+/**
+ * @brief Whether a path names a sidecar rather than a DIMACS file
+ */
+bool is_sidecar(const string& filepath)
+{
+    size_t n = strlen(SIDECAR_SUFFIX);
+    return filepath.size() >= n && filepath.compare(filepath.size() - n, n, SIDECAR_SUFFIX) == 0;
+}
+
+/**
+ * @brief Maps the sidecar of a DIMACS file if it is fresh
+ *
+ * A sidecar is fresh when it validates (see MappedArena::open()) and records
+ * the current size and modification time of @p filepath.
+ *
+ * @return bool False if there is no usable sidecar; @p mapped is closed then
+ */
+bool open_fresh_sidecar(const string& filepath, MappedArena& mapped)
+{
+    error_code ec;
+    uintmax_t size = fs::file_size(filepath, ec);
+    if(ec || !fs::exists(sidecar_path(filepath), ec)) return false;
+    if(!mapped.open(sidecar_path(filepath))) return false;
+
+    const SidecarHeader& h = mapped.header();
+    if(h.source_size != size || h.source_mtime != file_mtime(filepath))
+    {
+        mapped.close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses a DIMACS file and writes its binary sidecar
+ *
+ * The size and modification time are taken before parsing, so a file that
+ * changes during the conversion leaves a sidecar that is already stale.
+ *
+ * @return bool False if the file cannot be parsed or the sidecar not written
+ */
+bool convert_to_sidecar(const string& filepath)
+{
+    error_code ec;
+    uintmax_t size = fs::file_size(filepath, ec);
+    long long mtime = file_mtime(filepath);
+    if(ec) return false;
+
+    ClauseArena arena;
+    if(!load_arena(filepath, arena)) return false;
+    return write_sidecar(arena, size, mtime, sidecar_path(filepath));
+}
+
+/**
+ * @brief Opens a formula given as a DIMACS file or as a binary arena file
+ *
+ * A path ending in SIDECAR_SUFFIX is mapped directly; a DIMACS file is
+ * read through its sidecar when that is fresh, and parsed otherwise.
+ *
+ * @param mapped Holds the mapping when a binary file is used
+ * @param arena Holds the clauses when the file is parsed
+ * @param formula Receives the view of whichever was used
+ * @return bool False if the file cannot be read
+ */
+bool open_formula(const string& filepath, MappedArena& mapped, ClauseArena& arena, ArenaView& formula)
+{
+    if(is_sidecar(filepath) ? mapped.open(filepath) : open_fresh_sidecar(filepath, mapped))
+    {
+        formula = mapped.view();
+        return true;
+    }
+    if(is_sidecar(filepath) || !load_arena(filepath, arena)) return false;
+    formula = arena;
+    return true;
+}
+
+/**
+ * @brief Writes a formula as a DIMACS file
+ *
+ * The problem line gives the formula's variable count and its number of
+ * clauses. Literals are formatted into a buffer written out in large
+ * blocks.
+ *
+ * @return bool False if the file cannot be written
+ */
+bool write_dimacs(const ArenaView& formula, const string& out)
+{
+    ofstream f(out, ios::binary);
+    if(!f) return false;
+    f << "p cnf " << formula.var_no << " " << formula.size() << "\n";
+
+    string buf;
+    buf.reserve(1 << 20);
+    char digits[12];
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+        {
+            int64_t v = *p;
+            if(v < 0)
+            {
+                buf += '-';
+                v = -v;
+            }
+            int n = 0;
+            do
+            {
+                digits[n++] = (char)('0' + v % 10);
+                v /= 10;
+            } while(v > 0);
+            while(n > 0) buf += digits[--n];
+            buf += ' ';
+        }
+        buf += "0\n";
+        if(buf.size() > (1 << 20) - 256)
+        {
+            f.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+    f.write(buf.data(), buf.size());
+    return (bool)f;
+}
+
+/**
+ * @brief Writes a formula as DIMACS, or in the binary format if the path ends in SIDECAR_SUFFIX
+ *
+ * A binary file written this way records no source file, so it is read
+ * by naming it directly (see open_formula()), never as a sidecar.
+ */
+bool write_formula(const ClauseArena& formula, const string& out)
+{
+    return is_sidecar(out) ? write_sidecar(formula, 0, 0, out) : write_dimacs(formula, out);
+}
+
+/**
+ * @brief 64-bit finalizer that spreads every input bit over the output
+ */
+inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * @struct CnfFingerprint
+ * @brief Order-invariant fingerprint of a formula
+ *
+ * exact is a 128-bit hash that is the same for every file that has the same
+ * clauses, in any clause order and with the literals of each clause in any
+ * order. Each clause is hashed with its literals sorted, and the clause
+ * hashes are added up, which does not depend on the order of the terms.
+ *
+ * renaming is a 64-bit signature that is also the same after the variables
+ * are renamed and the polarities of some of them flipped, as in the
+ * "shuffled-as" copies of the SAT 2002/2003 corpora. It describes each literal by
+ * how often it and its complement occur, each clause by the multiset of
+ * its literal descriptions, and the formula by the multiset of its clause
+ * descriptions. Isomorphic formulas always share it, but unlike the exact
+ * hash it is not a proof of equality: different formulas with the same
+ * occurrence structure collide.
+ */
+struct CnfFingerprint
+{
+    int var_no = 0;
+    int clause_no = 0;
+    uint64_t exact[2] = {0, 0};
+    uint64_t renaming = 0;       ///< 0 if not computed
+
+    /// The exact fingerprint as 32 hex digits.
+    string exact_hex() const
+    {
+        char hex[40];
+        snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long)exact[0], (unsigned long long)exact[1]);
+        return hex;
+    }
+
+    /// The renaming-invariant signature as 16 hex digits.
+    string renaming_hex() const
+    {
+        char hex[20];
+        snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)renaming);
+        return hex;
+    }
+};
+
+/**
+ * @brief Adds one clause to the exact fingerprint
+ * @param scratch Reused buffer for the sorted literals
+ */
+inline void fingerprint_clause(const int32_t* first, const int32_t* last, vector<int32_t>& scratch, CnfFingerprint& fp)
+{
+    scratch.assign(first, last);
+    sort(scratch.begin(), scratch.end());
+    uint64_t h = hash_bytes(HASH_SEED, scratch.data(), scratch.size() * sizeof(int32_t));
+    h = hash_finish(h, scratch.size());
+    fp.exact[0] += mix64(h);
+    fp.exact[1] += mix64(h ^ 0x5851F42D4C957F2Dull);
+}
+
+/**
+ * @brief Computes the exact fingerprint in one streaming pass
+ * @param reader Reader positioned at the clause body (after read_header())
+ */
+CnfFingerprint fingerprint_stream(DimacsReader& reader)
+{
+    CnfFingerprint fp;
+    fp.var_no = reader.var_no;
+    fp.clause_no = reader.clause_no;
+
+    vector<int> lits;
+    vector<int32_t> clause, scratch;
+    while(reader.next_literals(lits))
+    {
+        for(int lit : lits)
+        {
+            if(lit != 0)
+            {
+                clause.push_back(lit);
+                continue;
+            }
+            fingerprint_clause(clause.data(), clause.data() + clause.size(), scratch, fp);
+            clause.clear();
+        }
+    }
+    return fp;
+}
+
+/**
+ * @brief Computes the exact fingerprint, and optionally the renaming-invariant signature, of a loaded formula
+ */
+CnfFingerprint fingerprint_arena(const ArenaView& arena, bool renaming)
+{
+    CnfFingerprint fp;
+    fp.var_no = arena.var_no;
+    fp.clause_no = arena.clause_no;
+
+    vector<int32_t> scratch;
+    for(size_t c = 0; c < arena.size(); c++) fingerprint_clause(arena.begin(c), arena.end(c), scratch, fp);
+    if(!renaming) return fp;
+
+    // Occurrences per literal, 2*v for v and 2*v+1 for -v; literals beyond
+    // the header's var_no are counted in a hash map so they cannot blow up
+    // the table
+    vector<uint32_t> occ(2 * ((size_t)max(arena.var_no, 0) + 1), 0);
+    unordered_map<size_t, uint32_t> occ_beyond;
+    auto index = [](int32_t lit) { return lit > 0 ? 2*(size_t)lit : 2*(size_t)(-(int64_t)lit) + 1; };
+    auto occurrences = [&](size_t idx) { return idx < occ.size() ? occ[idx] : occ_beyond.count(idx) ? occ_beyond[idx] : 0; };
+    for(size_t k = 0; k < arena.n_lits; k++)
+    {
+        size_t idx = index(arena.lits[k]);
+        if(idx < occ.size()) occ[idx]++;
+        else occ_beyond[idx]++;
+    }
+
+    uint64_t sig = 0;
+    for(size_t c = 0; c < arena.size(); c++)
+    {
+        uint64_t clause = mix64(arena.length(c));
+        for(const int32_t* p = arena.begin(c); p != arena.end(c); p++)
+        {
+            size_t idx = index(*p);
+            clause += mix64(((uint64_t)occurrences(idx) << 32) | occurrences(idx ^ 1));
+        }
+        sig += mix64(clause);
+    }
+    fp.renaming = mix64(sig ^ mix64(((uint64_t)(uint32_t)arena.var_no << 32) | (uint32_t)arena.clause_no));
+    if(fp.renaming == 0) fp.renaming = 1;
+    return fp;
+}
+
+/**
+ * @brief Fingerprints a DIMACS file
+ *
+ * A fresh sidecar is used when there is one. Otherwise the exact
+ * fingerprint is computed while streaming the file, and the file is loaded
+ * into a ClauseArena only when the renaming-invariant signature is wanted,
+ * since that needs the occurrence counts before the clauses are hashed.
+ *
+ * @return bool False if the file cannot be opened or has no problem line
+ */
+bool fingerprint_file(const string& filepath, bool renaming, bool use_sidecar, CnfFingerprint& fp)
+{
+    MappedArena mapped;
+    if(use_sidecar && open_fresh_sidecar(filepath, mapped))
+    {
+        fp = fingerprint_arena(mapped.view(), renaming);
+        return true;
+    }
+
+    DimacsReader reader(filepath);
+    if(!reader.is_open() || !reader.read_header()) return false;
+    if(!renaming)
+    {
+        fp = fingerprint_stream(reader);
+        return true;
+    }
+
+    ClauseArena arena;
+    error_code ec;
+    uintmax_t size = detect_compression(filepath) == Compression::None ? fs::file_size(filepath, ec) : 0;
+    load_arena(reader, arena, ec ? 0 : size);
+    fp = fingerprint_arena(arena, true);
+    return true;
+}
+
+/**
+ * @brief Counts the number of valid clauses in a CNF formula file
+ * 
+ * A clause is considered valid if it contains both a literal and its negation
+ * (e.g., x and -x), which makes the clause always satisfiable (tautology).
+ * 
+ * @param filepath Path to the CNF file in DIMACS format
+ * @return int Number of valid clauses found, or -1 if file cannot be opened
+ * 
+ * @note The CNF file should follow DIMACS format:
+ *       - Header line: p cnf <num_variables> <num_clauses>
+ *       - Each clause line contains space-separated integers ending with 0
+ *       - Negative numbers represent negated literals
+ * 
+ * @note Literals are decoded by DimacsReader, which uses the AVX2 kernel
+ *       when the CPU supports it.
+ *
+ * @warning This function opens and reads the file each time it's called
+ */
+int cnf_validcno(string filepath)
+{
+    DimacsReader reader(filepath);
+
+    if(!reader.is_open())
+    {
+        cout<<"File is not opened"<<endl;
+        return -1;
+    }
+
+    // Parse the problem line: p cnf <variables> <clauses>
+    reader.read_header();
+
+    return count_valid_clauses(reader, reader.var_no);
+}
+
+/**
+ * @brief Counts the number of non-valid (non-tautology) clauses in a CNF formula
+ * 
+ * Calculates the difference between total clauses and valid clauses.
+ * 
+ * @param filepath Path to the CNF file in DIMACS format
+ * @return int Number of non-valid clauses, or -1 if file cannot be opened
+ * 
+ * @see cnf_validcno()
+ */
+int cnf_non_valid_cno(string filepath)
+{
+    ifstream f(filepath);
+
+    if(!f.is_open())
+    {
+        cout<<"File is not opened"<<endl;
+        return -1;
+    }
+
+    string line;
+    string token;
+    
+    // Skip to problem line
+    while(getline(f,line))
+    {
+        if(line[0] == 'p') break;
+    }
+    
+    // Parse problem line
+    stringstream ss(line);
+    getline(ss,token,' ');
+    getline(ss,token,' ');
+    getline(ss,token,' ');
+    int var_no = stoi(token);
+    getline(ss,token,' ');
+    int clause_no = stoi(token);
+    int no;
+    
+    return clause_no-cnf_validcno(filepath);
+}
+
+/**
+ * @brief Checks if all clauses in a CNF formula are valid (tautologies)
+ * 
+ * A CNF formula is considered "valid" in this context if all of its clauses
+ * are tautologies (each contains both a literal and its negation).
+ * 
+ * @param filepath Path to the CNF file in DIMACS format
+ * @return bool True if all clauses are valid (tautologies), false otherwise
+ * @return bool Returns false (cast from -1) if file cannot be opened
+ * 
+ * @note This definition of "valid" is specific to this implementation and
+ *       differs from standard SAT terminology
+ * 
+ * @see cnf_validcno()
+ */
+bool cnf_validitychecker(string filepath)
+{
+    ifstream f(filepath);
+
+    if(!f.is_open())
+    {
+        cout<<"File is not opened"<<endl;
+        return -1;
+    }
+
+    string line;
+    string token;
+    
+    // Skip to problem line
+    while(getline(f,line))
+    {
+        if(line[0] == 'p') break;
+    }
+    
+    // Parse problem line
+    stringstream ss(line);
+    getline(ss,token,' ');
+    getline(ss,token,' ');
+    getline(ss,token,' ');
+    getline(ss,token,' ');
+    int clause_no = stoi(token);
+    int valid_clauseno = cnf_validcno(filepath);
+    f.close();
+    
+    if(valid_clauseno == clause_no) return true;
+    else return false;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Reads one "<key>: <value> kB" field from /proc/self/status
+ * @return size_t The value in KB, or 0 if it is not available
+ */
+size_t read_proc_status_kb(const string& key)
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while(getline(status, line))
+    {
+        if(line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':')
+        {
+            return stoul(line.substr(key.size() + 1));
+        }
+    }
+    return 0;
+}
+#endif
+
+/**
+ * @brief Get the current memory usage of the running process.
+ *
+ * Returns the resident set size: VmRSS from /proc/self/status on Linux,
+ * the working set size from GetProcessMemoryInfo() on Windows.
+ *
+ * @return size_t The current memory usage of the process in KB. Returns 0 if
+ *                the memory information cannot be retrieved.
+ *
+ * @note This measures the memory of the entire process, not a specific function
+ *       or file. Use ResourceMeter for per-file figures.
+ */
+size_t getMemoryKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.WorkingSetSize / 1024; // KB
+    }
+    return 0;
+#else
+    return read_proc_status_kb("VmRSS");
+#endif
+}
+
+/**
+ * @brief Get the highest memory usage of the running process so far.
+ *
+ * VmHWM from /proc/self/status (falling back to getrusage()) on Linux, the
+ * peak working set size on Windows.
+ *
+ * @return size_t Peak resident set size in KB, or 0 if it cannot be retrieved.
+ */
+size_t getPeakRssKB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.PeakWorkingSetSize / 1024; // KB
+    }
+    return 0;
+#else
+    size_t kb = read_proc_status_kb("VmHWM");
+    if (kb == 0) {
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) == 0) {
+#ifdef __APPLE__
+            kb = ru.ru_maxrss / 1024; // bytes on macOS
+#else
+            kb = ru.ru_maxrss;
+#endif
+        }
+    }
+    return kb;
+#endif
+}
+
+/**
+ * @brief Get the CPU time consumed so far by the calling thread or the whole process.
+ *
+ * Uses getrusage() (RUSAGE_THREAD where available) on POSIX systems and
+ * GetThreadTimes()/GetProcessTimes() on Windows.
+ *
+ * @param whole_process True for all threads of the process, false for the calling thread
+ * @return CpuTimes User and system time; zero if they cannot be retrieved.
+ */
+CpuTimes getCpuTimes(bool whole_process) {
+    CpuTimes t;
+#ifdef _WIN32
+    FILETIME creation, exit_time, kernel, user;
+    BOOL ok = whole_process ?
+              GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user) :
+              GetThreadTimes(GetCurrentThread(), &creation, &exit_time, &kernel, &user);
+    if (ok) {
+        auto ticks = [](const FILETIME& ft) {
+            return ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+        };
+        t.user_ms = ticks(user) / 10000.0; // 100 ns units to ms
+        t.sys_ms = ticks(kernel) / 10000.0;
+    }
+#else
+    struct rusage ru;
+#ifdef RUSAGE_THREAD
+    int who = whole_process ? RUSAGE_SELF : RUSAGE_THREAD;
+#else
+    int who = RUSAGE_SELF;
+#endif
+    if (getrusage(who, &ru) == 0) {
+        t.user_ms = ru.ru_utime.tv_sec * 1000.0 + ru.ru_utime.tv_usec / 1000.0;
+        t.sys_ms = ru.ru_stime.tv_sec * 1000.0 + ru.ru_stime.tv_usec / 1000.0;
+    }
+#endif
+    return t;
+}
+
+/// CPU time that helper threads (see PrefetchSource) spent for the calling thread.
+thread_local CpuTimes helper_cpu;
+
+/**
+ * @brief Adds CPU time a helper thread spent for the calling thread to helper_cpu
+ */
+void charge_helper_cpu(const CpuTimes& used) {
+    helper_cpu.user_ms += used.user_ms;
+    helper_cpu.sys_ms += used.sys_ms;
+}
+
+/**
+ * @brief Get the CPU time consumed so far by all threads of the process.
+ *
+ * @return double User plus system time in milliseconds, or 0 if it cannot be retrieved.
+ *
+ * @note Comparing this with wall-clock time over a parallel run gives the
+ *       average number of busy cores.
+ */
+double getCpuTimeMs() {
+    CpuTimes t = getCpuTimes(true);
+    return t.user_ms + t.sys_ms;
+}
+
+/**
+ * @struct FileResources
+ * @brief CPU and memory used while analyzing one file
+ */
+struct FileResources
+{
+    double user_ms = 0;          ///< User CPU time
+    double sys_ms = 0;           ///< System CPU time
+    size_t heap_peak_kb = 0;     ///< Peak heap in use above the level at the start
+    uint64_t allocated_bytes = 0;///< Total bytes allocated
+    size_t peak_rss_kb = 0;      ///< Peak RSS of the whole process when the file finished
+};
+
+/**
+ * @class ResourceMeter
+ * @brief Measures the CPU time and heap use of one analysis
+ *
+ * In thread mode the figures come from the calling thread (per-thread CPU
+ * clock and thread_heap) plus the decompression threads working for it
+ * (helper_cpu and the blocks PrefetchSource hands over), so they stay
+ * accurate while other workers analyze other files. Process mode is for an analysis that is itself spread
+ * over several threads and runs alone, such as cnf_validcno_split().
+ */
+class ResourceMeter
+{
+    public:
+        /**
+         * @brief Starts measuring
+         * @param whole_process Measure all threads instead of the calling one
+         */
+        ResourceMeter(bool whole_process) : process(whole_process)
+        {
+            cpu = cpu_now();
+            if(process)
+            {
+                live = process_heap_live.load();
+                process_heap_peak.store(live);
+                allocated = process_heap_allocated.load();
+            }
+            else
+            {
+                live = thread_heap.live;
+                thread_heap.peak = live;
+                allocated = thread_heap.allocated;
+            }
+        }
+
+        /**
+         * @brief Returns what was used since construction
+         */
+        FileResources stop()
+        {
+            FileResources r;
+            CpuTimes now = cpu_now();
+            r.user_ms = now.user_ms - cpu.user_ms;
+            r.sys_ms = now.sys_ms - cpu.sys_ms;
+
+            int64_t peak = process ? process_heap_peak.load() : thread_heap.peak;
+            uint64_t total = process ? process_heap_allocated.load() : thread_heap.allocated;
+            r.heap_peak_kb = peak > live ? (size_t)((peak - live) / 1024) : 0;
+            r.allocated_bytes = total - allocated;
+            r.peak_rss_kb = getPeakRssKB();
+            return r;
+        }
+
+    private:
+        bool process;
+        CpuTimes cpu;
+        int64_t live;
+        uint64_t allocated;
+
+        CpuTimes cpu_now() const
+        {
+            CpuTimes t = getCpuTimes(process);
+            if(!process)
+            {
+                t.user_ms += helper_cpu.user_ms;
+                t.sys_ms += helper_cpu.sys_ms;
+            }
+            return t;
+        }
+};
+
+/**
+ * @brief Runs task(0), ..., task(n_tasks-1) on a pool of worker threads
+ *
+ * Each worker repeatedly claims the next unstarted index from a shared
+ * atomic counter, so faster workers simply take more tasks. No more workers
+ * are started than there are tasks.
+ *
+ * @param n_tasks Number of tasks
+ * @param threads Most worker threads to use (1 runs everything on the caller)
+ * @param task Function called once for every index
+ */
+void parallel_for(size_t n_tasks, unsigned threads, const function<void(size_t)>& task)
+{
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < n_tasks; i = next++) {
+            task(i);
+        }
+    };
+
+    size_t workers = min<size_t>(threads, n_tasks);
+    if (workers <= 1) {
+        worker();
+        return;
+    }
+
+    vector<thread> pool;
+    for (size_t t = 0; t < workers; t++) pool.emplace_back(worker);
+    for (auto& th : pool) th.join();
+}
+
+/// Files whose clause body is at least this large are split across threads.
+const uintmax_t PARALLEL_SPLIT_BYTES = 64 << 20;
+
+/**
+ * @brief Finds the first clause boundary after a byte offset
+ *
+ * The offset may fall anywhere, even inside a comment, so the scan starts
+ * at the next line, the first place known to be a token boundary. From
+ * there it tokenizes the way parse_token_scalar() does: a token that is
+ * not a number or whitespace skips the rest of its line, so a `0` inside a
+ * comment is never taken for a clause end. The boundary is the position
+ * just after the first number token whose value is 0.
+ *
+ * @param f The CNF file, opened in binary mode; its position is changed
+ * @param offset Starting offset, must be past the problem line
+ * @param size Size of the file
+ * @return uintmax_t Offset of the boundary, or @p size if there is none
+ *         (or the '%' end marker comes first)
+ */
+uintmax_t next_clause_boundary(ifstream& f, uintmax_t offset, uintmax_t size)
+{
+    f.clear();
+    f.seekg((streamoff)offset);
+    vector<char> block(1 << 16);
+    enum { SKIP_LINE, BETWEEN, NUMBER } state = SKIP_LINE;
+    bool zero = true;  // every digit of the current number token is 0
+
+    for(uintmax_t pos = offset; pos < size; )
+    {
+        f.read(block.data(), block.size());
+        streamsize n = f.gcount();
+        if(n <= 0) break;
+        for(streamsize k = 0; k < n; k++, pos++)
+        {
+            char c = block[k];
+            if(state == NUMBER)
+            {
+                if(c >= '0' && c <= '9')
+                {
+                    zero = zero && c == '0';
+                    continue;
+                }
+                if(zero) return pos;
+                state = BETWEEN;
+            }
+            if(state == SKIP_LINE)
+            {
+                if(c == '\n') state = BETWEEN;
+            }
+            else if(c == '-' || (c >= '0' && c <= '9'))
+            {
+                state = NUMBER;
+                zero = c == '-' || c == '0';
+            }
+            else if(c == '%')
+            {
+                return size;
+            }
+            else if(c != ' ' && c != '\n' && c != '\t' && c != '\r')
+            {
+                state = SKIP_LINE;  // comment or any other non-clause line
+            }
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Counts valid clauses in one byte range of the clause body
+ *
+ * @param filepath Path to the CNF file
+ * @param var_no Number of variables from the header
+ * @param begin First byte of the range, at a clause boundary
+ * @param end One past the last byte, at a clause boundary
+ * @param end_marker Set to true if the range contains the '%' end marker
+ * @param budget Limits shared by all ranges of the file, or nullptr
+ * @return int Number of valid clauses completed inside the range
+ */
+int cnf_validcno_range(const string& filepath, int var_no, uintmax_t begin, uintmax_t end, bool& end_marker,
+                       Budget* budget = nullptr)
+{
+    DimacsReader reader(filepath);
+    reader.seek_range(begin, end);
+
+    int valid_clause_no = count_valid_clauses(reader, var_no, budget);
+    end_marker = reader.at_end_marker();
+    return valid_clause_no;
+}
+
+/**
+ * @brief Counts valid clauses, splitting a large file across threads
+ *
+ * The clause body is cut into @p threads byte ranges of equal size. Each
+ * cut is moved forward to the next clause boundary, the ranges are parsed
+ * and checked in parallel, and the per-range counts are added up. Ranges
+ * after one that contains the '%' end marker are ignored. Compressed files
+ * and files whose body is smaller than PARALLEL_SPLIT_BYTES are read in one
+ * piece, as cnf_validcno() does. The header is parsed once, here, and
+ * handed back so the caller need not read it again.
+ *
+ * @param filepath Path to the CNF file in DIMACS format
+ * @param threads Number of ranges (and threads) to use
+ * @param budget Limits for the whole file, or nullptr for none
+ * @param header_ok Set to whether the file has a well-formed problem line
+ * @param clause_no Set to the clause count of the problem line
+ * @return int Number of valid clauses found, or -1 if file cannot be opened
+ *
+ * @see cnf_validcno()
+ */
+int cnf_validcno_split(string filepath, unsigned threads, Budget* budget, bool& header_ok, int& clause_no)
+{
+    DimacsReader header(filepath);
+    header_ok = false;
+    clause_no = 0;
+    if(!header.is_open())
+    {
+        cout<<"File is not opened"<<endl;
+        return -1;
+    }
+    header_ok = header.read_header();
+    clause_no = header.clause_no;
+    uintmax_t size = fs::file_size(filepath);
+    uintmax_t body = header.body_offset();
+
+    if(threads <= 1 || detect_compression(filepath) != Compression::None || body >= size || size - body < PARALLEL_SPLIT_BYTES) return count_valid_clauses(header, header.var_no, budget);
+
+    vector<uintmax_t> cuts{body};
+    ifstream scan(filepath, ios::binary);
+    for(unsigned k = 1; k < threads; k++)
+    {
+        uintmax_t cut = next_clause_boundary(scan, max(cuts.back(), body + (size - body) * k / threads), size);
+        if(cut > cuts.back() && cut < size) cuts.push_back(cut);
+    }
+    cuts.push_back(size);
+
+    size_t ranges = cuts.size() - 1;
+    vector<int> partial(ranges);
+    vector<char> end_marker(ranges);
+    parallel_for(ranges, threads, [&](size_t k) {
+        bool marker = false;
+        if(k == 0)
+        {
+            // The header reader already stands at the start of the body
+            header.seek_range(cuts[0], cuts[1]);
+            partial[0] = count_valid_clauses(header, header.var_no, budget);
+            marker = header.at_end_marker();
+        }
+        else
+        {
+            partial[k] = cnf_validcno_range(filepath, header.var_no, cuts[k], cuts[k+1], marker, budget);
+        }
+        end_marker[k] = marker;
+    });
+
+    int valid_clause_no = 0;
+    for(size_t k = 0; k < ranges; k++)
+    {
+        valid_clause_no += partial[k];
+        if(end_marker[k]) break;
+    }
+    return valid_clause_no;
+}
+
+/// Outcome of a satisfiability search.
+enum class SatResult { Unknown, Sat, Unsat };
+
+/**
+ * @brief Chooses how a solver numbers the variables of a formula
+ *
+ * Solvers keep arrays per variable. When the DIMACS variable numbers are
+ * much larger than the formula, the variables that occur are numbered
+ * densely from 0 in order of first occurrence, so that those arrays stay
+ * proportional to the formula; otherwise DIMACS variable v is solver
+ * variable v - 1.
+ *
+ * @param formula The formula to number
+ * @param dense Receives the dense numbering, or is left empty when the
+ *              DIMACS numbering is used as it is
+ * @return int Number of solver variables
+ */
+int number_variables(const ArenaView& formula, unordered_map<int, int>& dense)
+{
+    dense.clear();
+    int max_var = max(formula.var_no, 0);
+    for(size_t k = 0; k < formula.n_lits; k++) max_var = max(max_var, (int)abs((int64_t)formula.lits[k]));
+    if((size_t)max_var <= 2 * formula.n_lits + 1024) return max_var;
+
+    for(size_t k = 0; k < formula.n_lits; k++) dense.emplace((int)abs((int64_t)formula.lits[k]), (int)dense.size());
+    return (int)dense.size();
+}
+
+/**
+ * @struct SolverStats
+ * @brief Search statistics of one CdclSolver run
+ */
+struct SolverStats
+{
+    uint64_t decisions = 0;
+    uint64_t conflicts = 0;
+    uint64_t propagations = 0;   ///< Literals whose watch lists were visited
+    uint64_t restarts = 0;
+    uint64_t learned = 0;        ///< Learned clauses with two or more literals
+    uint64_t deleted = 0;        ///< Learned clauses removed again
+    uint64_t flips = 0;          ///< Variable flips of the local search probe
+    double time_ms = 0;          ///< Wall-clock time of solve()
+};
+
+/**
+ * @class CdclSolver
+ * @brief Conflict-driven clause-learning SAT solver
+ *
+ * A compact solver in the style of MiniSat:
+ * - clauses live in one flat pool of 32-bit words and are watched by two
+ *   literals, each watcher caching a blocker literal that, when true, lets
+ *   propagation skip the clause without touching its memory;
+ * - conflicts are analyzed to the first unique implication point, and the
+ *   learned clause is shortened by dropping literals implied by the others;
+ * - decisions take the unassigned variable of highest VSIDS activity from a
+ *   binary heap, with the polarity it last had (phase saving);
+ * - restarts follow the Luby sequence in units of RESTART_BASE conflicts;
+ * - when learned clauses outnumber a growing limit, the less active half
+ *   (except binary clauses and current reasons) is deleted and the pool is
+ *   compacted once half of it is garbage.
+ *
+ * Tautological clauses and repeated literals are dropped when loading.
+ */
+class CdclSolver
+{
+    public:
+        SolverStats stats;
+
+        /**
+         * @brief Loads a formula
+         * @param formula Clauses in DIMACS numbering; variables above the
+         *                header's count are allowed
+         *
+         * Sparse variable numbers are renumbered (see number_variables()).
+         */
+        CdclSolver(const ArenaView& formula)
+        {
+            init_vars(number_variables(formula, dense_index));
+
+            vector<Lit> clause;
+            for(size_t c = 0; c < formula.size() && ok; c++)
+            {
+                clause.clear();
+                for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+                {
+                    if(dense_index.empty()) clause.push_back(to_lit(*p));
+                    else clause.push_back(2*(Lit)dense_index[(int)abs((int64_t)*p)] + (*p < 0));
+                }
+                add_clause(clause);
+            }
+        }
+
+        /**
+         * @brief Searches for a satisfying assignment
+         * @param budget File limits, checked periodically; nullptr for none
+         * @param max_seconds Time budget of the search; 0 for none
+         * @return SatResult Unknown if a budget ran out first
+         */
+        SatResult solve(Budget* budget = nullptr, double max_seconds = 0)
+        {
+            auto start = chrono::steady_clock::now();
+            auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max_seconds));
+            SatResult result = search(budget, max_seconds > 0, deadline);
+            stats.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            return result;
+        }
+
+        /**
+         * @brief Value of a variable in the model found by solve()
+         * @param var DIMACS variable number
+         */
+        bool model_value(int var) const
+        {
+            if(!dense_index.empty())
+            {
+                auto it = dense_index.find(var);
+                return it != dense_index.end() && model[it->second];
+            }
+            return var >= 1 && var <= n_vars && model[var - 1];
+        }
+
+        /// Number of variables searched over, including any above the header's count.
+        int vars() const
+        {
+            return n_vars;
+        }
+
+    private:
+        typedef uint32_t Lit;    ///< 2*var + 1 if negated, var counted from 0
+        typedef uint32_t CRef;   ///< Offset of a clause in the pool
+
+        static constexpr CRef NO_REASON = 0xFFFFFFFFu;
+        static constexpr uint8_t L_FALSE = 0, L_TRUE = 1, L_UNDEF = 2;
+        static constexpr uint32_t LEARNT = 1, DELETED = 2;
+        static constexpr int HEADER = 3;             ///< Words before the literals: size, flags, activity
+        static constexpr uint64_t RESTART_BASE = 100;
+
+        struct Watcher
+        {
+            CRef cref;
+            Lit blocker;
+        };
+
+        bool ok = true;                          ///< False once the formula is known to be unsatisfiable
+        int n_vars = 0;
+        size_t n_clauses = 0;                    ///< Original clauses in the pool
+        vector<uint32_t> pool;                   ///< Clause headers and literals
+        size_t wasted = 0;                       ///< Pool words of deleted clauses
+        vector<CRef> learnts;
+        vector<vector<Watcher>> watches;         ///< Per literal, the clauses watching it
+        vector<uint8_t> assigns;                 ///< Per variable: L_FALSE, L_TRUE or L_UNDEF
+        vector<uint8_t> phase;                   ///< Saved polarity, 1 for negative
+        vector<int> level;
+        vector<CRef> reason;
+        vector<Lit> trail;
+        vector<size_t> trail_lim;                ///< Trail size at the start of each decision level
+        size_t qhead = 0;
+        vector<double> activity;
+        double var_inc = 1;
+        float cla_inc = 1;
+        vector<int> heap;                        ///< Variables ordered by activity, highest first
+        vector<int> heap_pos;                    ///< Index in heap, or -1
+        vector<char> seen;
+        vector<Lit> learnt_clause;
+        vector<char> model;
+        double max_learnts = 0;
+        unordered_map<int, int> dense_index;     ///< Solver numbering of sparse formulas, see number_variables()
+
+        static Lit to_lit(int32_t dimacs)
+        {
+            return dimacs > 0 ? 2*(Lit)(dimacs - 1) : 2*(Lit)(-(int64_t)dimacs - 1) + 1;
+        }
+
+        static int var(Lit l)
+        {
+            return (int)(l >> 1);
+        }
+
+        uint8_t value(Lit l) const
+        {
+            uint8_t a = assigns[var(l)];
+            return a == L_UNDEF ? L_UNDEF : (uint8_t)(a ^ (l & 1));
+        }
+
+        int decision_level() const
+        {
+            return (int)trail_lim.size();
+        }
+
+        uint32_t& clause_size(CRef c) { return pool[c]; }
+        uint32_t& clause_flags(CRef c) { return pool[c + 1]; }
+        Lit* clause_lits(CRef c) { return &pool[c + HEADER]; }
+
+        float clause_activity(CRef c) const
+        {
+            float a;
+            memcpy(&a, &pool[c + 2], sizeof(a));
+            return a;
+        }
+
+        void set_clause_activity(CRef c, float a)
+        {
+            memcpy(&pool[c + 2], &a, sizeof(a));
+        }
+
+        void init_vars(int n)
+        {
+            n_vars = n;
+            watches.assign(2 * (size_t)n, vector<Watcher>());
+            assigns.assign(n, L_UNDEF);
+            phase.assign(n, 1);
+            level.assign(n, 0);
+            reason.assign(n, NO_REASON);
+            activity.assign(n, 0);
+            heap_pos.assign(n, -1);
+            seen.assign(n, 0);
+            for(int v = 0; v < n; v++) heap_insert(v);
+        }
+
+        /// Normalizes and stores an original clause; false if the formula became unsatisfiable.
+        bool add_clause(vector<Lit>& c)
+        {
+            sort(c.begin(), c.end());
+            size_t j = 0;
+            for(size_t i = 0; i < c.size(); i++)
+            {
+                if(j > 0 && c[i] == c[j-1]) continue;              // repeated literal
+                if(j > 0 && c[i] == (c[j-1] ^ 1)) return true;     // tautology, always satisfied
+                c[j++] = c[i];
+            }
+            c.resize(j);
+
+            if(c.empty()) return ok = false;
+            if(c.size() == 1)
+            {
+                if(value(c[0]) == L_FALSE) return ok = false;
+                if(value(c[0]) == L_UNDEF) enqueue(c[0], NO_REASON);
+                return true;
+            }
+            attach(alloc_clause(c, false));
+            n_clauses++;
+            return true;
+        }
+
+        CRef alloc_clause(const vector<Lit>& c, bool learnt)
+        {
+            CRef cr = (CRef)pool.size();
+            pool.push_back((uint32_t)c.size());
+            pool.push_back(learnt ? LEARNT : 0);
+            pool.push_back(0);
+            pool.insert(pool.end(), c.begin(), c.end());
+            return cr;
+        }
+
+        void attach(CRef cr)
+        {
+            Lit* c = clause_lits(cr);
+            watches[c[0]].push_back({cr, c[1]});
+            watches[c[1]].push_back({cr, c[0]});
+        }
+
+        void enqueue(Lit l, CRef from)
+        {
+            int v = var(l);
+            assigns[v] = (uint8_t)(1 - (l & 1));
+            level[v] = decision_level();
+            reason[v] = from;
+            trail.push_back(l);
+        }
+
+        /**
+         * @brief Unit propagation over the watch lists
+         * @return CRef The conflicting clause, or NO_REASON
+         */
+        CRef propagate()
+        {
+            CRef conflict = NO_REASON;
+            while(qhead < trail.size())
+            {
+                Lit false_lit = trail[qhead++] ^ 1;
+                vector<Watcher>& ws = watches[false_lit];
+                stats.propagations++;
+
+                size_t i = 0, j = 0, n = ws.size();
+                while(i < n)
+                {
+                    Lit blocker = ws[i].blocker;
+                    if(value(blocker) == L_TRUE)
+                    {
+                        ws[j++] = ws[i++];
+                        continue;
+                    }
+
+                    CRef cr = ws[i].cref;
+                    Lit* c = clause_lits(cr);
+                    if(c[0] == false_lit) swap(c[0], c[1]);
+                    i++;
+
+                    Lit first = c[0];
+                    Watcher w = {cr, first};
+                    if(first != blocker && value(first) == L_TRUE)
+                    {
+                        ws[j++] = w;
+                        continue;
+                    }
+
+                    // Look for a new literal to watch
+                    uint32_t size = clause_size(cr);
+                    bool moved = false;
+                    for(uint32_t k = 2; k < size; k++)
+                    {
+                        if(value(c[k]) != L_FALSE)
+                        {
+                            c[1] = c[k];
+                            c[k] = false_lit;
+                            watches[c[1]].push_back(w);
+                            moved = true;
+                            break;
+                        }
+                    }
+                    if(moved) continue;
+
+                    // The clause is unit or conflicting
+                    ws[j++] = w;
+                    if(value(first) == L_FALSE)
+                    {
+                        conflict = cr;
+                        qhead = trail.size();
+                        while(i < n) ws[j++] = ws[i++];
+                    }
+                    else
+                    {
+                        enqueue(first, cr);
+                    }
+                }
+                ws.resize(j);
+            }
+            return conflict;
+        }
+
+        /**
+         * @brief Derives the first-UIP clause of a conflict
+         * @param conflict The falsified clause
+         * @return int The level to backjump to; learnt_clause[0] is asserting there
+         */
+        int analyze(CRef conflict)
+        {
+            learnt_clause.assign(1, 0);
+            int pending = 0;
+            Lit p = 0;
+            bool first = true;
+            size_t index = trail.size();
+
+            do
+            {
+                if(clause_flags(conflict) & LEARNT) bump_clause(conflict);
+                Lit* c = clause_lits(conflict);
+                uint32_t size = clause_size(conflict);
+                for(uint32_t k = first ? 0 : 1; k < size; k++)
+                {
+                    int v = var(c[k]);
+                    if(seen[v] || level[v] == 0) continue;
+                    bump_var(v);
+                    seen[v] = 1;
+                    if(level[v] >= decision_level()) pending++;
+                    else learnt_clause.push_back(c[k]);
+                }
+                first = false;
+
+                // Next literal of the current level on the trail
+                while(!seen[var(trail[--index])]) {}
+                p = trail[index];
+                conflict = reason[var(p)];
+                seen[var(p)] = 0;
+                pending--;
+            } while(pending > 0);
+            learnt_clause[0] = p ^ 1;
+
+            // Drop literals whose reason consists of literals already in the clause
+            vector<Lit> to_clear(learnt_clause.begin() + 1, learnt_clause.end());
+            size_t j = 1;
+            for(size_t i = 1; i < learnt_clause.size(); i++)
+            {
+                CRef r = reason[var(learnt_clause[i])];
+                bool redundant = (r != NO_REASON);
+                if(redundant)
+                {
+                    Lit* c = clause_lits(r);
+                    for(uint32_t k = 1; k < clause_size(r); k++)
+                    {
+                        int v = var(c[k]);
+                        if(!seen[v] && level[v] > 0)
+                        {
+                            redundant = false;
+                            break;
+                        }
+                    }
+                }
+                if(!redundant) learnt_clause[j++] = learnt_clause[i];
+            }
+            learnt_clause.resize(j);
+            for(Lit l : to_clear) seen[var(l)] = 0;
+
+            // The literal of the highest remaining level goes second, to be watched
+            if(learnt_clause.size() == 1) return 0;
+            size_t max_i = 1;
+            for(size_t i = 2; i < learnt_clause.size(); i++)
+            {
+                if(level[var(learnt_clause[i])] > level[var(learnt_clause[max_i])]) max_i = i;
+            }
+            swap(learnt_clause[1], learnt_clause[max_i]);
+            return level[var(learnt_clause[1])];
+        }
+
+        void cancel_until(int target)
+        {
+            if(decision_level() <= target) return;
+            for(size_t k = trail.size(); k-- > trail_lim[target]; )
+            {
+                int v = var(trail[k]);
+                assigns[v] = L_UNDEF;
+                reason[v] = NO_REASON;
+                phase[v] = (uint8_t)(trail[k] & 1);
+                if(heap_pos[v] < 0) heap_insert(v);
+            }
+            trail.resize(trail_lim[target]);
+            trail_lim.resize(target);
+            qhead = trail.size();
+        }
+
+        /// Luby sequence 1, 1, 2, 1, 1, 2, 4, ... (index from 0).
+        static uint64_t luby(uint64_t x)
+        {
+            uint64_t size = 1, seq = 0;
+            while(size < x + 1)
+            {
+                seq++;
+                size = 2 * size + 1;
+            }
+            while(size - 1 != x)
+            {
+                size = (size - 1) / 2;
+                seq--;
+                x = x % size;
+            }
+            return (uint64_t)1 << seq;
+        }
+
+        SatResult search(Budget* budget, bool timed, chrono::steady_clock::time_point deadline)
+        {
+            model.clear();
+            if(!ok) return SatResult::Unsat;
+            max_learnts = max(1000.0, n_clauses / 3.0);
+
+            uint64_t restart_limit = luby(0) * RESTART_BASE;
+            uint64_t conflicts_here = 0;
+            for(uint64_t round = 0; ; round++)
+            {
+                if((round & 1023) == 0)
+                {
+                    if(budget && budget->exceeded()) return SatResult::Unknown;
+                    if(timed && chrono::steady_clock::now() > deadline) return SatResult::Unknown;
+                }
+
+                CRef conflict = propagate();
+                if(conflict != NO_REASON)
+                {
+                    stats.conflicts++;
+                    conflicts_here++;
+                    if(decision_level() == 0) return SatResult::Unsat;
+
+                    int back = analyze(conflict);
+                    cancel_until(back);
+                    if(learnt_clause.size() == 1)
+                    {
+                        enqueue(learnt_clause[0], NO_REASON);
+                    }
+                    else
+                    {
+                        CRef cr = alloc_clause(learnt_clause, true);
+                        learnts.push_back(cr);
+                        attach(cr);
+                        bump_clause(cr);
+                        enqueue(learnt_clause[0], cr);
+                        stats.learned++;
+                    }
+                    var_inc /= 0.95;
+                    cla_inc /= 0.999f;
+                    continue;
+                }
+
+                if(conflicts_here >= restart_limit)
+                {
+                    stats.restarts++;
+                    conflicts_here = 0;
+                    restart_limit = luby(stats.restarts) * RESTART_BASE;
+                    cancel_until(0);
+                    continue;
+                }
+                if((double)learnts.size() >= max_learnts + trail.size())
+                {
+                    reduce_learnts();
+                    max_learnts *= 1.1;
+                }
+
+                int next = -1;
+                while(!heap.empty())
+                {
+                    int v = heap_pop();
+                    if(assigns[v] == L_UNDEF)
+                    {
+                        next = v;
+                        break;
+                    }
+                }
+                if(next < 0)
+                {
+                    model.assign(n_vars, 0);
+                    for(int v = 0; v < n_vars; v++) model[v] = (assigns[v] == L_TRUE);
+                    return SatResult::Sat;
+                }
+
+                stats.decisions++;
+                trail_lim.push_back(trail.size());
+                enqueue(2*(Lit)next + phase[next], NO_REASON);
+            }
+        }
+
+        // --- VSIDS ---
+
+        void bump_var(int v)
+        {
+            if((activity[v] += var_inc) > 1e100)
+            {
+                for(double& a : activity) a *= 1e-100;
+                var_inc *= 1e-100;
+            }
+            if(heap_pos[v] >= 0) heap_up(heap_pos[v]);
+        }
+
+        void bump_clause(CRef cr)
+        {
+            float a = clause_activity(cr) + cla_inc;
+            set_clause_activity(cr, a);
+            if(a > 1e20f)
+            {
+                for(CRef l : learnts) set_clause_activity(l, clause_activity(l) * 1e-20f);
+                cla_inc *= 1e-20f;
+            }
+        }
+
+        void heap_insert(int v)
+        {
+            heap_pos[v] = (int)heap.size();
+            heap.push_back(v);
+            heap_up(heap_pos[v]);
+        }
+
+        int heap_pop()
+        {
+            int top = heap[0];
+            heap[0] = heap.back();
+            heap_pos[heap[0]] = 0;
+            heap.pop_back();
+            heap_pos[top] = -1;
+            if(!heap.empty()) heap_down(0);
+            return top;
+        }
+
+        void heap_up(int i)
+        {
+            int v = heap[i];
+            while(i > 0)
+            {
+                int parent = (i - 1) / 2;
+                if(activity[heap[parent]] >= activity[v]) break;
+                heap[i] = heap[parent];
+                heap_pos[heap[i]] = i;
+                i = parent;
+            }
+            heap[i] = v;
+            heap_pos[v] = i;
+        }
+
+        void heap_down(int i)
+        {
+            int v = heap[i];
+            int n = (int)heap.size();
+            while(2 * i + 1 < n)
+            {
+                int child = 2 * i + 1;
+                if(child + 1 < n && activity[heap[child + 1]] > activity[heap[child]]) child++;
+                if(activity[heap[child]] <= activity[v]) break;
+                heap[i] = heap[child];
+                heap_pos[heap[i]] = i;
+                i = child;
+            }
+            heap[i] = v;
+            heap_pos[v] = i;
+        }
+
+        // --- Learned clause deletion ---
+
+        bool locked(CRef cr)
+        {
+            Lit first = clause_lits(cr)[0];
+            return reason[var(first)] == cr && value(first) == L_TRUE;
+        }
+
+        void reduce_learnts()
+        {
+            sort(learnts.begin(), learnts.end(), [&](CRef a, CRef b) {
+                return clause_activity(a) < clause_activity(b);
+            });
+
+            size_t j = 0;
+            for(size_t i = 0; i < learnts.size(); i++)
+            {
+                CRef cr = learnts[i];
+                if(i < learnts.size() / 2 && clause_size(cr) > 2 && !locked(cr))
+                {
+                    clause_flags(cr) |= DELETED;
+                    wasted += HEADER + clause_size(cr);
+                    stats.deleted++;
+                }
+                else
+                {
+                    learnts[j++] = cr;
+                }
+            }
+            learnts.resize(j);
+
+            for(vector<Watcher>& ws : watches)
+            {
+                ws.erase(remove_if(ws.begin(), ws.end(), [&](const Watcher& w) {
+                    return (clause_flags(w.cref) & DELETED) != 0;
+                }), ws.end());
+            }
+            if(wasted > pool.size() / 2) compact_pool();
+        }
+
+        /// Moves the live clauses to a new pool and updates every reference.
+        void compact_pool()
+        {
+            vector<uint32_t> fresh;
+            fresh.reserve(pool.size() - wasted);
+            for(CRef cr = 0; cr < pool.size(); cr += HEADER + pool[cr])
+            {
+                if(pool[cr + 1] & DELETED) continue;
+                CRef to = (CRef)fresh.size();
+                fresh.insert(fresh.end(), pool.begin() + cr, pool.begin() + cr + HEADER + pool[cr]);
+                pool[cr + 2] = to;   // the old activity slot now holds the new offset
+            }
+
+            for(vector<Watcher>& ws : watches)
+            {
+                for(Watcher& w : ws) w.cref = pool[w.cref + 2];
+            }
+            for(CRef& cr : learnts) cr = pool[cr + 2];
+            for(Lit l : trail)
+            {
+                CRef& r = reason[var(l)];
+                if(r != NO_REASON) r = pool[r + 2];
+            }
+            pool.swap(fresh);
+            wasted = 0;
+        }
+};
+
+/**
+ * @brief Converts a model from solver numbering to DIMACS numbering
+ *
+ * @param dense The numbering from number_variables()
+ * @param n_vars Number of solver variables
+ * @param value Returns the value of a solver variable
+ * @param model Receives the value of each DIMACS variable, indexed by
+ *              variable number (index 0 unused)
+ */
+template<class Value>
+void dimacs_model(const unordered_map<int, int>& dense, int n_vars, Value value, vector<char>& model)
+{
+    if(dense.empty())
+    {
+        model.assign((size_t)n_vars + 1, 0);
+        for(int v = 0; v < n_vars; v++) model[(size_t)v + 1] = value(v);
+        return;
+    }
+    int max_var = 0;
+    for(auto& kv : dense) max_var = max(max_var, kv.first);
+    model.assign((size_t)max_var + 1, 0);
+    for(auto& kv : dense) model[kv.first] = value(kv.second);
+}
+
+/**
+ * @brief Finds the strongly connected components of a graph in compressed sparse row form
+ *
+ * Tarjan's algorithm, run with an explicit stack so that long implication
+ * chains cannot overflow the call stack, in O(n + m).
+ *
+ * @param first Per node, the offset of its first edge in @p target, plus
+ *              the end of the last node's edges
+ * @param target Edge targets
+ * @param comp Receives the component of each node, components numbered in
+ *             reverse topological order
+ * @param budget File limits, checked periodically; nullptr for none
+ * @return bool False if the budget ran out
+ */
+bool strongly_connected_components(const vector<uint64_t>& first, const vector<uint32_t>& target,
+                                   vector<uint32_t>& comp, Budget* budget = nullptr)
+{
+    const uint32_t NONE = 0xFFFFFFFFu;
+    size_t n_nodes = first.size() - 1;
+    vector<uint32_t> index(n_nodes, NONE), low(n_nodes);
+    comp.assign(n_nodes, NONE);
+    vector<uint32_t> stack;
+    vector<pair<uint32_t, uint64_t>> path;   // DFS path: node and its next edge
+    uint32_t counter = 0, n_comps = 0;
+    size_t steps = 0;
+    for(uint32_t root = 0; root < n_nodes; root++)
+    {
+        if(index[root] != NONE) continue;
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        path.push_back({root, first[root]});
+
+        while(!path.empty())
+        {
+            if(budget && (++steps & 0xFFFF) == 0 && budget->exceeded()) return false;
+
+            uint32_t u = path.back().first;
+            if(path.back().second < first[u + 1])
+            {
+                uint32_t w = target[path.back().second++];
+                if(index[w] == NONE)
+                {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    path.push_back({w, first[w]});
+                }
+                else if(comp[w] == NONE)
+                {
+                    low[u] = min(low[u], index[w]);   // w is still on the stack
+                }
+                continue;
+            }
+
+            path.pop_back();
+            if(low[u] == index[u])
+            {
+                uint32_t w;
+                do
+                {
+                    w = stack.back();
+                    stack.pop_back();
+                    comp[w] = n_comps;
+                } while(w != u);
+                n_comps++;
+            }
+            if(!path.empty()) low[path.back().first] = min(low[path.back().first], low[u]);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decides a formula whose clauses have at most two literals
+ *
+ * Builds the implication graph (each clause (a b) gives the edges -a -> b
+ * and -b -> a, a unit clause (a) the edge -a -> a) in compressed sparse row
+ * form: one offset per literal and one 32-bit target per edge, filled in
+ * two passes over the clauses without per-node lists, and finds its
+ * strongly connected components in O(n + m) (see
+ * strongly_connected_components()). The formula is unsatisfiable exactly
+ * when a variable shares a component with its negation; otherwise each
+ * literal whose component comes after its negation's in topological order
+ * is set true.
+ *
+ * Tautological clauses are skipped and (a a) is read as (a). Sparse
+ * variable numbers are renumbered (see number_variables()).
+ *
+ * @param formula Clauses of at most two literals each
+ * @param budget File limits, checked periodically; nullptr for none
+ * @param model Receives the value of each DIMACS variable, indexed by
+ *              variable number, when satisfiable; nullptr if not needed
+ * @return SatResult Unknown if the budget ran out or a clause has more
+ *         than two literals
+ */
+SatResult solve_2sat(const ArenaView& formula, Budget* budget = nullptr, vector<char>* model = nullptr)
+{
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto node = [&](int32_t lit) -> uint32_t {
+        int v = (int)abs((int64_t)lit);
+        return 2 * (uint32_t)(dense.empty() ? v - 1 : dense[v]) + (lit < 0);
+    };
+
+    // Out-degrees first, then the edge targets at their final offsets
+    size_t n_nodes = 2 * (size_t)n_vars;
+    vector<uint64_t> first(n_nodes + 1, 0);
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        size_t len = formula.length(c);
+        if(len == 0) return SatResult::Unsat;
+        if(len > 2) return SatResult::Unknown;
+
+        const int32_t* lits = formula.begin(c);
+        if(lits[0] == -lits[len - 1]) continue;
+        uint32_t a = node(lits[0]), b = node(lits[len - 1]);
+        first[(a ^ 1) + 1]++;
+        if(a != b) first[(b ^ 1) + 1]++;
+    }
+    for(size_t u = 0; u < n_nodes; u++) first[u + 1] += first[u];
+
+    vector<uint32_t> target(first[n_nodes]);
+    {
+        vector<uint64_t> next(first.begin(), first.end() - 1);
+        for(size_t c = 0; c < formula.size(); c++)
+        {
+            const int32_t* lits = formula.begin(c);
+            size_t len = formula.length(c);
+            if(lits[0] == -lits[len - 1]) continue;
+            uint32_t a = node(lits[0]), b = node(lits[len - 1]);
+            target[next[a ^ 1]++] = b;
+            if(a != b) target[next[b ^ 1]++] = a;
+        }
+    }
+    if(budget && budget->exceeded()) return SatResult::Unknown;
+
+    vector<uint32_t> comp;
+    if(!strongly_connected_components(first, target, comp, budget)) return SatResult::Unknown;
+
+    for(size_t v = 0; v < (size_t)n_vars; v++)
+    {
+        if(comp[2 * v] == comp[2 * v + 1]) return SatResult::Unsat;
+    }
+
+    // Positive literal true when its component is nearer the sinks
+    if(model) dimacs_model(dense, n_vars, [&](int v) { return (char)(comp[2 * (size_t)v] < comp[2 * (size_t)v + 1]); }, *model);
+    return SatResult::Sat;
+}
+
+/**
+ * @brief Tells whether every clause has at most one positive literal
+ */
+bool is_horn(const ArenaView& formula)
+{
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        int positive = 0;
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++) positive += (*p > 0);
+        if(positive > 1) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Looks for a renaming that makes a formula Horn
+ *
+ * Flipping the sign of a set of variables makes every clause Horn exactly
+ * when, for each clause, at most one of its literals is positive after the
+ * flip. With x_v meaning "v is flipped", literal l is positive after the
+ * flip exactly when the literal -l holds over the x_v, so each clause asks
+ * for at most one of its negated literals to hold. That is 2-CNF: a pair
+ * (l1 l2) for binary clauses and a ladder of auxiliary variables s_i,
+ * (l_i s_i) (-s_i s_i+1) (-s_i l_i+1), for longer ones, linear in the size
+ * of the formula. solve_2sat() decides it.
+ *
+ * @param formula The formula to rename
+ * @param flip Receives, per variable as numbered by number_variables(),
+ *             1 if its sign is to be flipped
+ * @param budget File limits, checked periodically; nullptr for none
+ * @return bool True if a renaming exists and was found within the budget
+ */
+bool find_horn_renaming(const ArenaView& formula, vector<char>& flip, Budget* budget = nullptr)
+{
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto var_of = [&](int32_t lit) { int v = (int)abs((int64_t)lit); return dense.empty() ? v : dense[v] + 1; };
+
+    // Clause variables keep their (dense) numbers, ladder variables follow
+    ClauseArena ladder;
+    int next_var = n_vars;
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        const int32_t* lits = formula.begin(c);
+        size_t len = formula.length(c);
+        auto lit = [&](size_t i) { return lits[i] < 0 ? -var_of(lits[i]) : var_of(lits[i]); };
+        if(len == 2)
+        {
+            int32_t pair[2] = {lit(0), lit(1)};
+            ladder.add_clause(pair, pair + 2);
+            continue;
+        }
+        for(size_t i = 0; len > 2 && i + 1 < len; i++)
+        {
+            if(next_var == INT_MAX) return false;
+            int32_t s = ++next_var;
+            int32_t take[2] = {lit(i), s};
+            int32_t block[2] = {-s, lit(i + 1)};
+            ladder.add_clause(take, take + 2);
+            ladder.add_clause(block, block + 2);
+            if(i + 2 < len)
+            {
+                int32_t chain[2] = {-s, s + 1};
+                ladder.add_clause(chain, chain + 2);
+            }
+        }
+        if(budget && budget->exceeded()) return false;
+    }
+    ladder.var_no = next_var;
+    ladder.clause_no = (int)min<size_t>(ladder.size(), INT_MAX);
+
+    vector<char> model;
+    if(solve_2sat(ladder, budget, &model) != SatResult::Sat) return false;
+    flip.assign(n_vars, 0);
+    for(int v = 0; v < n_vars; v++) flip[v] = (size_t)v + 1 < model.size() && model[(size_t)v + 1];
+    return true;
+}
+
+/**
+ * @brief Decides a Horn formula in linear time
+ *
+ * Starts from all variables false and sets a variable true only when some
+ * clause forces it: every clause keeps a counter of its negative literals
+ * whose variables are still false, and when it drops to zero the clause's
+ * positive literal is set true and queued, or, if it has none, the formula
+ * is unsatisfiable. Each negative occurrence is visited once, so the work
+ * is linear in the size of the formula, and the result is the least model.
+ *
+ * @param formula Clauses with at most one positive literal each, after
+ *                applying @p flip
+ * @param flip Renaming from find_horn_renaming(), or nullptr for a formula
+ *             that is Horn as it stands
+ * @param budget File limits, checked periodically; nullptr for none
+ * @param model Receives the value of each DIMACS variable, indexed by
+ *              variable number, when satisfiable; nullptr if not needed
+ * @return SatResult Unknown if the budget ran out or a clause is not Horn
+ */
+SatResult solve_horn(const ArenaView& formula, const vector<char>* flip = nullptr, Budget* budget = nullptr, vector<char>* model = nullptr)
+{
+    const uint32_t NONE = 0xFFFFFFFFu;
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto var_of = [&](int32_t lit) {
+        int v = (int)abs((int64_t)lit);
+        return (uint32_t)(dense.empty() ? v - 1 : dense[v]);
+    };
+    auto is_negative = [&](int32_t lit) { return (lit < 0) != (flip && (*flip)[var_of(lit)]); };
+
+    // Per clause: false negative literals and the positive literal; per
+    // variable: the clauses it occurs negatively in, in CSR form
+    vector<uint32_t> pending(formula.size(), 0), head(formula.size(), NONE);
+    vector<uint64_t> first((size_t)n_vars + 1, 0);
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+        {
+            uint32_t v = var_of(*p);
+            if(is_negative(*p))
+            {
+                pending[c]++;
+                first[(size_t)v + 1]++;
+            }
+            else if(head[c] == NONE || head[c] == v)
+            {
+                head[c] = v;
+            }
+            else
+            {
+                return SatResult::Unknown;
+            }
+        }
+    }
+    for(size_t v = 0; v < (size_t)n_vars; v++) first[v + 1] += first[v];
+    vector<uint32_t> occurs(first[n_vars]);
+    {
+        vector<uint64_t> next(first.begin(), first.end() - 1);
+        for(size_t c = 0; c < formula.size(); c++)
+        {
+            for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+            {
+                if(is_negative(*p)) occurs[next[var_of(*p)]++] = (uint32_t)c;
+            }
+        }
+    }
+
+    vector<char> value(n_vars, 0);
+    vector<uint32_t> queue;
+    auto fire = [&](size_t c) {
+        if(head[c] == NONE) return false;
+        if(!value[head[c]])
+        {
+            value[head[c]] = 1;
+            queue.push_back(head[c]);
+        }
+        return true;
+    };
+
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        if(pending[c] == 0 && !fire(c)) return SatResult::Unsat;
+    }
+    for(size_t q = 0; q < queue.size(); q++)
+    {
+        if(budget && (q & 0xFFFF) == 0 && budget->exceeded()) return SatResult::Unknown;
+        uint32_t v = queue[q];
+        for(uint64_t k = first[v]; k < first[(size_t)v + 1]; k++)
+        {
+            if(--pending[occurs[k]] == 0 && !fire(occurs[k])) return SatResult::Unsat;
+        }
+    }
+
+    if(model) dimacs_model(dense, n_vars, [&](int v) { return (char)(value[v] != (flip && (*flip)[v])); }, *model);
+    return SatResult::Sat;
+}
+
+/**
+ * @class ProbSatSearch
+ * @brief One ProbSAT local search over a formula in solver numbering
+ *
+ * Starts from a random assignment and repeatedly picks a random unsatisfied
+ * clause and flips one of its variables, chosen with probability falling
+ * with its break count (the clauses the flip would leave unsatisfied):
+ * (eps + break)^-cb for 3-SAT and cb^-break for longer clauses, with the
+ * constants of Balint and Schoening. Per clause it keeps the number of
+ * true literals and the XOR of their variables, which is the one critical
+ * variable when a single literal is true; break counts are updated from
+ * these on every flip, and the unsatisfied clauses are kept in a list with
+ * O(1) removal by position.
+ */
+class ProbSatSearch
+{
+    public:
+        /**
+         * @param lits Clause literals as 2*var + 1 if negated, in CSR form
+         * @param first Offset of each clause in @p lits, plus the end
+         * @param occurs Clauses of each literal, in CSR form
+         * @param occurs_first Offset of each literal in @p occurs, plus the end
+         * @param n_vars Number of variables
+         * @param max_length Longest clause, which selects the constants
+         * @param seed Seed of this search's random numbers
+         */
+        ProbSatSearch(const vector<uint32_t>& lits, const vector<uint64_t>& first,
+                      const vector<uint32_t>& occurs, const vector<uint64_t>& occurs_first,
+                      int n_vars, size_t max_length, uint64_t seed) :
+            lits(lits), first(first), occurs(occurs), occurs_first(occurs_first),
+            value(n_vars), break_count(n_vars, 0), true_count(first.size() - 1, 0),
+            critical(first.size() - 1, 0), unsat_pos(first.size() - 1, NONE), state(seed | 1)
+        {
+            double cb = max_length <= 3 ? 2.06 : max_length == 4 ? 3.0 : max_length == 5 ? 3.7 : max_length == 6 ? 5.1 : 5.4;
+            for(size_t b = 0; b < BREAK_TABLE; b++) weight[b] = max_length <= 3 ? pow(0.9 + b, -cb) : pow(cb, -(double)b);
+
+            for(size_t v = 0; v < value.size(); v++) value[v] = (char)(next_random() & 1);
+            for(size_t c = 0; c + 1 < first.size(); c++)
+            {
+                for(uint64_t k = first[c]; k < first[c + 1]; k++)
+                {
+                    if(is_true(lits[k]))
+                    {
+                        true_count[c]++;
+                        critical[c] ^= lits[k] >> 1;
+                    }
+                }
+                if(true_count[c] == 0) make_unsat(c);
+                else if(true_count[c] == 1) break_count[critical[c]]++;
+            }
+        }
+
+        /**
+         * @brief Flips variables until no clause is unsatisfied or @p keep_going says stop
+         * @param keep_going Called every 4096 flips; returns false to give up
+         * @return bool True if the current assignment satisfies the formula
+         */
+        bool run(const function<bool()>& keep_going)
+        {
+            vector<double> prob;
+            while(!unsat.empty())
+            {
+                if((++flips & 4095) == 0 && !keep_going()) return false;
+
+                uint32_t c = unsat[next_random() % unsat.size()];
+                double sum = 0;
+                prob.clear();
+                for(uint64_t k = first[c]; k < first[c + 1]; k++)
+                {
+                    prob.push_back(weight[min<size_t>(break_count[lits[k] >> 1], BREAK_TABLE - 1)]);
+                    sum += prob.back();
+                }
+                double pick = (double)(next_random() >> 11) * (1.0 / 9007199254740992.0) * sum;
+                uint64_t k = first[c];
+                for(size_t i = 0; i + 1 < prob.size() && pick >= prob[i]; i++, k++) pick -= prob[i];
+                flip(lits[k] >> 1);
+            }
+            return true;
+        }
+
+        /// Current value of a variable.
+        bool value_of(int v) const
+        {
+            return value[v];
+        }
+
+        uint64_t flips = 0;
+
+    private:
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+        static constexpr size_t BREAK_TABLE = 64;
+
+        const vector<uint32_t>& lits;
+        const vector<uint64_t>& first;
+        const vector<uint32_t>& occurs;
+        const vector<uint64_t>& occurs_first;
+        vector<char> value;
+        vector<uint32_t> break_count;   ///< Per variable, clauses it alone satisfies
+        vector<uint32_t> true_count;    ///< Per clause, true literals
+        vector<uint32_t> critical;      ///< Per clause, XOR of the variables of its true literals
+        vector<uint32_t> unsat;         ///< Unsatisfied clauses, in no order
+        vector<uint32_t> unsat_pos;     ///< Index in unsat, or NONE
+        double weight[BREAK_TABLE];
+        uint64_t state;
+
+        uint64_t next_random()
+        {
+            // xorshift64*
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545F4914F6CDD1DULL;
+        }
+
+        bool is_true(uint32_t lit) const
+        {
+            return value[lit >> 1] != (char)(lit & 1);
+        }
+
+        void make_unsat(uint32_t c)
+        {
+            unsat_pos[c] = (uint32_t)unsat.size();
+            unsat.push_back(c);
+        }
+
+        void make_sat(uint32_t c)
+        {
+            uint32_t last = unsat.back();
+            unsat[unsat_pos[c]] = last;
+            unsat_pos[last] = unsat_pos[c];
+            unsat.pop_back();
+            unsat_pos[c] = NONE;
+        }
+
+        void flip(uint32_t v)
+        {
+            value[v] ^= 1;
+            uint32_t now_true = 2 * v + (value[v] ? 0 : 1);
+            for(uint64_t k = occurs_first[now_true]; k < occurs_first[now_true + 1]; k++)
+            {
+                uint32_t c = occurs[k];
+                if(true_count[c] == 0)
+                {
+                    make_sat(c);
+                    break_count[v]++;
+                }
+                else if(true_count[c] == 1)
+                {
+                    break_count[critical[c]]--;
+                }
+                true_count[c]++;
+                critical[c] ^= v;
+            }
+            uint32_t now_false = now_true ^ 1;
+            for(uint64_t k = occurs_first[now_false]; k < occurs_first[now_false + 1]; k++)
+            {
+                uint32_t c = occurs[k];
+                true_count[c]--;
+                critical[c] ^= v;
+                if(true_count[c] == 0)
+                {
+                    make_unsat(c);
+                    break_count[v]--;
+                }
+                else if(true_count[c] == 1)
+                {
+                    break_count[critical[c]]++;
+                }
+            }
+        }
+};
+
+/**
+ * @brief Looks for a satisfying assignment by local search within a short time
+ *
+ * Runs one ProbSatSearch per thread, each with its own seed, until one of
+ * them satisfies the formula, the time is up or the file's budget runs
+ * out. Tautological clauses are dropped and repeated literals merged
+ * first. Local search cannot show that a formula is unsatisfiable, so the
+ * answer is Sat or Unknown.
+ *
+ * @param formula The formula to probe
+ * @param threads Independent searches to run at once
+ * @param max_seconds Time budget of the probe
+ * @param budget File limits, checked periodically; nullptr for none
+ * @param stats Receives the number of flips, summed over the searches
+ * @param model Receives the value of each DIMACS variable, indexed by
+ *              variable number, when satisfiable; nullptr if not needed
+ * @param seed Seed of the first search; search k uses seed + k
+ * @return SatResult Sat if an assignment was found, Unknown otherwise
+ */
+SatResult probe_probsat(const ArenaView& formula, unsigned threads, double max_seconds, Budget* budget,
+                        SolverStats& stats, vector<char>* model = nullptr, uint64_t seed = 2002)
+{
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto lit_of = [&](int32_t lit) {
+        int v = (int)abs((int64_t)lit);
+        return 2 * (uint32_t)(dense.empty() ? v - 1 : dense[v]) + (lit < 0);
+    };
+
+    // Clauses without tautologies and repeated literals, and their occurrences
+    vector<uint32_t> lits;
+    vector<uint64_t> first{0};
+    vector<uint64_t> occurs_first(2 * (size_t)n_vars + 1, 0);
+    size_t max_length = 0;
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        // Sorted, a literal and its negation are neighbours
+        size_t start = lits.size();
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++) lits.push_back(lit_of(*p));
+        sort(lits.begin() + start, lits.end());
+        lits.erase(unique(lits.begin() + start, lits.end()), lits.end());
+        bool tautology = false;
+        for(size_t k = start + 1; k < lits.size(); k++) tautology |= (lits[k] == (lits[k - 1] ^ 1));
+        if(tautology)
+        {
+            lits.resize(start);
+            continue;
+        }
+        if(lits.size() == start) return SatResult::Unknown;   // empty clause
+        for(size_t k = start; k < lits.size(); k++) occurs_first[lits[k] + 1]++;
+        max_length = max(max_length, lits.size() - start);
+        first.push_back(lits.size());
+    }
+    for(size_t l = 0; l + 1 < occurs_first.size(); l++) occurs_first[l + 1] += occurs_first[l];
+    vector<uint32_t> occurs(lits.size());
+    {
+        vector<uint64_t> next(occurs_first.begin(), occurs_first.end() - 1);
+        for(size_t c = 0; c + 1 < first.size(); c++)
+        {
+            for(uint64_t k = first[c]; k < first[c + 1]; k++) occurs[next[lits[k]]++] = (uint32_t)c;
+        }
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max_seconds));
+    atomic<bool> found(false);
+    atomic<uint64_t> flips(0);
+    mutex winner;
+    threads = max(1u, threads);
+    parallel_for(threads, threads, [&](size_t k) {
+        ProbSatSearch search(lits, first, occurs, occurs_first, n_vars, max_length, seed + k);
+        bool solved = search.run([&]() {
+            return !found.load(memory_order_relaxed) && chrono::steady_clock::now() < deadline && !(budget && budget->exceeded());
+        });
+        flips += search.flips;
+        if(!solved) return;
+
+        lock_guard<mutex> lock(winner);
+        if(found.exchange(true)) return;
+        if(model) dimacs_model(dense, n_vars, [&](int v) { return (char)search.value_of(v); }, *model);
+    });
+    stats.flips += flips;
+    return found ? SatResult::Sat : SatResult::Unknown;
+}
+
+/// 64-bit words of assignments that verify_assignments() evaluates per pass.
+const size_t VERIFY_BLOCK_WORDS = 4;
+
+/// verify_assignments() result for an assignment that contains both x and -x.
+const int64_t VERIFY_CONTRADICTORY = -2;
+
+/**
+ * @brief Checks many assignments against a formula at once
+ *
+ * The assignments are bit-sliced in blocks of 64 * VERIFY_BLOCK_WORDS: for
+ * every literal of the formula, a block holds one bit per assignment, set
+ * when the assignment makes the literal true. One pass over the clauses
+ * then evaluates each clause for the whole block as the OR of its literals'
+ * words, and the zero bits are the assignments it violates. Blocks are
+ * checked in parallel, and a block stops early once all its assignments
+ * have failed. A variable that an assignment leaves out makes neither of
+ * its literals true, so every variable of a violated clause must be set.
+ * An assignment that contains both x and -x is not an assignment at all
+ * and is rejected before any clause is checked.
+ *
+ * @param formula The formula, typically from load_arena() or a sidecar
+ * @param assignments Each a list of DIMACS literals, true in the assignment
+ * @param threads Blocks to check at once
+ * @return vector<int64_t> Per assignment, the index of the first clause it
+ *         violates, -1 if it satisfies every clause, or
+ *         VERIFY_CONTRADICTORY if it sets a variable both true and false
+ */
+vector<int64_t> verify_assignments(const ArenaView& formula, const vector<vector<int32_t>>& assignments, unsigned threads)
+{
+    const size_t W = VERIFY_BLOCK_WORDS, PER_BLOCK = 64 * VERIFY_BLOCK_WORDS;
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto index_of = [&](int64_t v) -> int64_t {
+        if(dense.empty()) return v >= 1 && v <= n_vars ? v - 1 : -1;
+        auto it = dense.find((int)v);
+        return it == dense.end() ? -1 : it->second;
+    };
+
+    // The formula in literal indices, translated once for all blocks
+    vector<uint32_t> lits(formula.n_lits);
+    for(size_t k = 0; k < formula.n_lits; k++) lits[k] = 2 * (uint32_t)index_of(abs((int64_t)formula.lits[k])) + (formula.lits[k] < 0);
+
+    vector<int64_t> violated(assignments.size(), -1);
+    size_t n_blocks = (assignments.size() + PER_BLOCK - 1) / PER_BLOCK;
+    parallel_for(n_blocks, threads, [&](size_t b) {
+        size_t base = b * PER_BLOCK, count = min(PER_BLOCK, assignments.size() - base);
+
+        // Transpose: bit i of a literal's words is assignment base + i
+        vector<uint64_t> words(2 * (size_t)n_vars * W, 0);
+        uint64_t contradictory[VERIFY_BLOCK_WORDS] = {};
+        vector<int64_t> others;  // literals of variables outside the formula, checked by sorting
+        for(size_t i = 0; i < count; i++)
+        {
+            uint64_t bit = 1ull << (i % 64);
+            others.clear();
+            for(int32_t lit : assignments[base + i])
+            {
+                int64_t v = index_of(abs((int64_t)lit));
+                if(v < 0)
+                {
+                    others.push_back(lit);
+                    continue;
+                }
+                words[(2 * (size_t)v + (lit < 0)) * W + i / 64] |= bit;
+                if(words[(2 * (size_t)v + (lit > 0)) * W + i / 64] & bit) contradictory[i / 64] |= bit;
+            }
+            sort(others.begin(), others.end(), [](int64_t a, int64_t b) { return llabs(a) < llabs(b) || (llabs(a) == llabs(b) && a < b); });
+            for(size_t k = 1; k < others.size(); k++)
+            {
+                if(others[k] == -others[k - 1]) contradictory[i / 64] |= bit;
+            }
+        }
+
+        uint64_t pending[VERIFY_BLOCK_WORDS] = {};
+        for(size_t i = 0; i < count; i++)
+        {
+            uint64_t bit = 1ull << (i % 64);
+            if(contradictory[i / 64] & bit) violated[base + i] = VERIFY_CONTRADICTORY;
+            else pending[i / 64] |= bit;
+        }
+
+        for(size_t c = 0; c < formula.size(); c++)
+        {
+            uint64_t sat[VERIFY_BLOCK_WORDS] = {};
+            for(uint64_t k = formula.offsets[c]; k < formula.offsets[c + 1]; k++)
+            {
+                const uint64_t* w = &words[(size_t)lits[k] * W];
+                for(size_t j = 0; j < W; j++) sat[j] |= w[j];
+            }
+
+            uint64_t left = 0;
+            for(size_t j = 0; j < W; j++)
+            {
+                uint64_t missed = pending[j] & ~sat[j];
+                pending[j] &= ~missed;
+                left |= pending[j];
+                for(; missed; missed &= missed - 1) violated[base + j * 64 + __builtin_ctzll(missed)] = (int64_t)c;
+            }
+            if(left == 0) break;
+        }
+    });
+    return violated;
+}
+
+/// Bytes the DRAT proof reader takes from its stream at a time.
+const size_t DRAT_CHUNK_SIZE = 1 << 20;
+
+/**
+ * @class DratReader
+ * @brief Streams the steps of a DRAT proof, in text or binary form
+ *
+ * Reads through open_source(), so compressed proofs work too, and holds one
+ * DRAT_CHUNK_SIZE buffer at a time however long the proof is. The form is
+ * detected from the first bytes: binary proofs ('a' and 'd' steps followed
+ * by variable-length literals 2*var + sign, ended by 0) contain bytes that
+ * are not printable.
+ */
+class DratReader
+{
+    public:
+        DratReader(const string& filepath) : src(open_source(filepath)), buf(DRAT_CHUNK_SIZE) {}
+
+        bool is_open()
+        {
+            return src != nullptr;
+        }
+
+        /**
+         * @brief Reads the next step
+         * @param lits Cleared, then filled with the step's literals
+         * @param deletion Set for a deletion, cleared for an added lemma
+         * @return bool False at the end of the proof or on malformed input
+         *         (see failed())
+         */
+        bool next(vector<int32_t>& lits, bool& deletion)
+        {
+            lits.clear();
+            if(!detected) detect();
+            return binary ? next_binary(lits, deletion) : next_text(lits, deletion);
+        }
+
+        /// Whether reading stopped at malformed input.
+        bool failed() const
+        {
+            return error;
+        }
+
+        /// Bytes consumed so far, for locating errors and reporting.
+        uintmax_t bytes_read() const
+        {
+            return consumed;
+        }
+
+    private:
+        unique_ptr<ByteSource> src;
+        vector<char> buf;
+        size_t pos = 0;
+        size_t len = 0;
+        uintmax_t consumed = 0;
+        bool detected = false;
+        bool binary = false;
+        bool error = false;
+
+        int peek()
+        {
+            if(pos == len)
+            {
+                len = src->read(buf.data(), buf.size());
+                pos = 0;
+                if(len == 0) return -1;
+            }
+            return (unsigned char)buf[pos];
+        }
+
+        int get()
+        {
+            int c = peek();
+            if(c >= 0)
+            {
+                pos++;
+                consumed++;
+            }
+            return c;
+        }
+
+        void detect()
+        {
+            detected = true;
+            if(peek() < 0) return;
+            // Every binary step ends in a 0 byte; text proofs are printable
+            binary = (buf[pos] == 'a');
+            for(size_t i = pos; i < len && i < pos + 64; i++)
+            {
+                unsigned char c = (unsigned char)buf[i];
+                if((c < 32 && !isspace(c)) || c > 126) binary = true;
+            }
+        }
+
+        bool next_text(vector<int32_t>& lits, bool& deletion)
+        {
+            deletion = false;
+            bool started = false;
+            while(true)
+            {
+                int c = get();
+                if(c < 0)
+                {
+                    error = started;   // a step without its closing 0
+                    return false;
+                }
+                if(isspace(c)) continue;
+                if(c == 'c' && !started)
+                {
+                    while((c = get()) >= 0 && c != '\n') {}
+                    continue;
+                }
+                if(c == 'd' && !started)
+                {
+                    deletion = started = true;
+                    continue;
+                }
+
+                bool negative = (c == '-');
+                if(negative) c = get();
+                if(c < 0 || !isdigit(c))
+                {
+                    error = true;
+                    return false;
+                }
+                int64_t v = 0;
+                for(; c >= 0 && isdigit(c); c = get())
+                {
+                    v = v * 10 + (c - '0');
+                    if(v > INT32_MAX)
+                    {
+                        error = true;
+                        return false;
+                    }
+                }
+                if(c >= 0 && !isspace(c))
+                {
+                    error = true;
+                    return false;
+                }
+                if(v == 0) return true;
+                lits.push_back(negative ? -(int32_t)v : (int32_t)v);
+                started = true;
+            }
+        }
+
+        bool next_binary(vector<int32_t>& lits, bool& deletion)
+        {
+            int c = get();
+            if(c < 0) return false;
+            if(c != 'a' && c != 'd')
+            {
+                error = true;
+                return false;
+            }
+            deletion = (c == 'd');
+            while(true)
+            {
+                uint64_t code = 0;
+                int shift = 0;
+                do
+                {
+                    c = get();
+                    if(c < 0 || shift > 35)
+                    {
+                        error = true;
+                        return false;
+                    }
+                    code |= (uint64_t)(c & 0x7F) << shift;
+                    shift += 7;
+                } while(c & 0x80);
+
+                if(code == 0) return true;
+                if((code >> 1) > INT32_MAX)
+                {
+                    error = true;
+                    return false;
+                }
+                int32_t v = (int32_t)(code >> 1);
+                lits.push_back(code & 1 ? -v : v);
+            }
+        }
+};
+
+/**
+ * @class DratChecker
+ * @brief Checks a DRAT refutation of a formula by backward verification
+ *
+ * Proof steps are applied as they are read (the forward pass): lemmas are
+ * added, deleted clauses are looked up in a hash table keyed by their
+ * literal set and removed, and units are propagated at the top level until
+ * a conflict shows the formula refuted, after which the rest of the proof
+ * is not needed. verify() then walks the steps backwards, removing each
+ * lemma and checking it only if the refutation used it: by reverse unit
+ * propagation (RUP) or, failing that, as a resolution asymmetric tautology
+ * (RAT) on the lemma's first literal. Every clause in the conflicts found
+ * joins the core, and propagation visits core clauses before the others so
+ * that the core stays small. Propagation uses two watched literals.
+ *
+ * Deletions of unit clauses and of clauses that are the reason for a
+ * top-level assignment are ignored, as DRAT checkers usually do.
+ */
+class DratChecker
+{
+    public:
+        size_t lemmas = 0;
+        size_t deletions = 0;
+        size_t ignored_deletions = 0;   ///< Of unit or reason clauses, or of clauses not found
+        size_t core_clauses = 0;        ///< Clauses of the formula used by the refutation
+        size_t core_lemmas = 0;         ///< Lemmas used by the refutation, each checked
+        int64_t failed_lemma = -1;      ///< Number (from 1) of the first lemma that failed its check
+        string message;                 ///< Why verify() failed
+
+        /**
+         * @brief Loads the formula and propagates its unit clauses
+         */
+        DratChecker(const ArenaView& formula)
+        {
+            for(size_t c = 0; c < formula.size(); c++) add(formula.begin(c), formula.end(c), false);
+            n_original = flags.size();
+            if(top_conflict == NONE) top_conflict = propagate();
+        }
+
+        /// Whether the steps so far refute the formula; later steps are not needed.
+        bool refuted() const
+        {
+            return top_conflict != NONE;
+        }
+
+        /**
+         * @brief Applies one proof step in the forward pass
+         */
+        void add_step(const vector<int32_t>& step, bool deletion)
+        {
+            if(refuted()) return;
+            if(!deletion)
+            {
+                lemmas++;
+                uint32_t c = add(step.data(), step.data() + step.size(), true);
+                steps.push_back(c);
+                lemma_number.push_back(lemmas);
+                if(top_conflict == NONE) top_conflict = propagate();
+                return;
+            }
+
+            query.clear();
+            for(int32_t lit : step) query.push_back(lit_of(lit));
+            sort(query.begin(), query.end());
+            query.erase(unique(query.begin(), query.end()), query.end());
+            size_t slot = table_find(query);
+            if(slot == NONE)
+            {
+                ignored_deletions++;
+                return;
+            }
+            uint32_t c = table[slot];
+            if(length(c) <= 1 || is_reason(c))
+            {
+                ignored_deletions++;
+                return;
+            }
+            table[slot] = TOMBSTONE;
+            detach(c);
+            steps.push_back(c | DELETION);
+            lemma_number.push_back(0);
+            deletions++;
+        }
+
+        /**
+         * @brief Runs the backward pass over the steps read so far
+         * @param budget File limits, checked periodically; nullptr for none
+         * @return bool True if the proof is verified
+         */
+        bool verify(Budget* budget = nullptr)
+        {
+            if(!refuted())
+            {
+                message = "the proof does not derive a conflict";
+                return false;
+            }
+            mark_core(top_conflict);
+
+            for(size_t s = steps.size(); s-- > 0;)
+            {
+                if(budget && (s & 1023) == 0 && budget->exceeded())
+                {
+                    message = "stopped by a limit";
+                    return false;
+                }
+
+                uint32_t c = steps[s] & ~DELETION;
+                if(steps[s] & DELETION)
+                {
+                    flags[c] |= ACTIVE;
+                    attach(c);
+                    continue;
+                }
+                detach(c);
+                if(!(flags[c] & CORE)) continue;
+
+                core_lemmas++;
+                if(!check_lemma(c))
+                {
+                    failed_lemma = (int64_t)lemma_number[s];
+                    message = "lemma " + to_string(failed_lemma) + " is neither RUP nor RAT";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        typedef uint32_t Lit;   ///< 2*var + 1 if negated, var counted from 0
+
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+        static constexpr uint32_t TOMBSTONE = 0xFFFFFFFEu;
+        static constexpr uint32_t DELETION = 0x80000000u;   ///< Marks a deletion in steps
+        static constexpr uint8_t ACTIVE = 1, LEMMA = 2, CORE = 4;
+        static constexpr int8_t L_FALSE = -1, L_UNDEF = 0, L_TRUE = 1;
+
+        vector<Lit> lits;                     ///< Literals of all clauses, sorted when added
+        vector<uint64_t> offsets{0};
+        vector<uint8_t> flags;                ///< Per clause: ACTIVE, LEMMA, CORE
+        vector<Lit> pivot;                    ///< Per clause: first literal as written, for RAT
+        size_t n_original = 0;
+        vector<uint32_t> steps;               ///< Clause added, or deleted if DELETION is set
+        vector<size_t> lemma_number;          ///< Per step: lemma number from 1, 0 for deletions
+
+        vector<uint32_t> table;               ///< Open addressing: active clauses by literal set
+        vector<uint64_t> table_hash;
+        size_t table_used = 0;                ///< Slots not empty, including tombstones
+
+        vector<int8_t> value;                 ///< Per literal
+        vector<uint32_t> reason;              ///< Per variable
+        vector<uint32_t> trail_pos;           ///< Per variable
+        vector<char> seen;                    ///< Per variable
+        vector<uint32_t> stamp;               ///< Per literal, for comparing clauses
+        uint32_t stamp_id = 0;
+        vector<vector<uint32_t>> watches;     ///< Per literal, clauses watching it
+        vector<vector<uint32_t>> occurs;      ///< Per literal, every clause containing it; built at the first RAT check
+        vector<uint32_t> units;               ///< Active unit clauses
+        vector<Lit> trail;
+        size_t core_head = 0;                 ///< Next trail literal for the core clauses
+        size_t all_head = 0;                  ///< Next trail literal for all clauses
+        uint32_t top_conflict = NONE;         ///< Clause falsified at the top level
+        bool units_dirty = false;             ///< Units must be assigned again after a rollback
+        vector<Lit> query;
+
+        static Lit lit_of(int32_t dimacs)
+        {
+            return dimacs > 0 ? 2*(Lit)(dimacs - 1) : 2*(Lit)(-(int64_t)dimacs - 1) + 1;
+        }
+
+        size_t length(uint32_t c) const
+        {
+            return (size_t)(offsets[c + 1] - offsets[c]);
+        }
+
+        Lit* clause(uint32_t c)
+        {
+            return &lits[offsets[c]];
+        }
+
+        void ensure_literal(Lit l)
+        {
+            if((size_t)l < value.size()) return;
+            size_t n_lits = max<size_t>(2 * ((size_t)(l >> 1) + 1), value.size() * 3 / 2 & ~(size_t)1);
+            value.resize(n_lits, L_UNDEF);
+            stamp.resize(n_lits, 0);
+            watches.resize(n_lits);
+            reason.resize(n_lits / 2, NONE);
+            trail_pos.resize(n_lits / 2, 0);
+            seen.resize(n_lits / 2, 0);
+        }
+
+        uint64_t hash_of(const Lit* b, const Lit* e) const
+        {
+            uint64_t h = 0;
+            for(; b != e; b++) h += mix64((uint64_t)*b + 1);
+            return h;
+        }
+
+        uint32_t add(const int32_t* b, const int32_t* e, bool lemma)
+        {
+            uint32_t c = (uint32_t)flags.size();
+            size_t start = lits.size();
+            for(const int32_t* p = b; p != e; p++)
+            {
+                lits.push_back(lit_of(*p));
+                ensure_literal(lits.back());
+            }
+            pivot.push_back(lemma && b != e ? lits[start] : NONE);
+            sort(lits.begin() + start, lits.end());
+            lits.erase(unique(lits.begin() + start, lits.end()), lits.end());
+            offsets.push_back(lits.size());
+            flags.push_back(ACTIVE | (lemma ? LEMMA : 0));
+            table_insert(c, hash_of(&lits[start], lits.data() + lits.size()));
+            attach(c);
+            return c;
+        }
+
+        void table_insert(uint32_t c, uint64_t h)
+        {
+            if((table_used + 1) * 2 > table.size())
+            {
+                vector<uint32_t> old = move(table);
+                vector<uint64_t> old_hash = move(table_hash);
+                table.assign(max<size_t>(1024, old.size() * 2), NONE);
+                table_hash.assign(table.size(), 0);
+                table_used = 0;
+                for(size_t i = 0; i < old.size(); i++)
+                {
+                    if(old[i] != NONE && old[i] != TOMBSTONE) table_insert(old[i], old_hash[i]);
+                }
+            }
+            size_t mask = table.size() - 1, i = h & mask;
+            while(table[i] != NONE) i = (i + 1) & mask;
+            table[i] = c;
+            table_hash[i] = h;
+            table_used++;
+        }
+
+        /// Slot of an active clause with exactly the literals in @p sorted, or NONE.
+        size_t table_find(const vector<Lit>& sorted)
+        {
+            if(table.empty()) return NONE;
+            for(Lit l : sorted) ensure_literal(l);
+            uint64_t h = hash_of(sorted.data(), sorted.data() + sorted.size());
+            stamp_id++;
+            for(Lit l : sorted) stamp[l] = stamp_id;
+
+            size_t mask = table.size() - 1;
+            for(size_t i = h & mask; table[i] != NONE; i = (i + 1) & mask)
+            {
+                uint32_t c = table[i];
+                if(c == TOMBSTONE || table_hash[i] != h || length(c) != sorted.size()) continue;
+                Lit* L = clause(c);
+                if(all_of(L, L + length(c), [&](Lit l) { return stamp[l] == stamp_id; })) return i;
+            }
+            return NONE;
+        }
+
+        void assign(Lit l, uint32_t why)
+        {
+            value[l] = L_TRUE;
+            value[l ^ 1] = L_FALSE;
+            reason[l >> 1] = why;
+            trail_pos[l >> 1] = (uint32_t)trail.size();
+            trail.push_back(l);
+        }
+
+        /// Unassigns trail[p...]; only the assumptions of a RUP check go this way.
+        void backtrack(size_t p)
+        {
+            for(size_t k = p; k < trail.size(); k++) value[trail[k]] = value[trail[k] ^ 1] = L_UNDEF;
+            trail.resize(p);
+            core_head = min(core_head, p);
+            all_head = min(all_head, p);
+        }
+
+        /**
+         * @brief Unassigns trail[p...] after the clause behind trail[p] was removed
+         *
+         * Clauses watching literals still false may now be unit, so all of
+         * the trail is propagated again, and the unit clauses reasserted.
+         */
+        void rollback(size_t p)
+        {
+            backtrack(p);
+            core_head = all_head = 0;
+            top_conflict = NONE;
+            units_dirty = true;
+        }
+
+        bool is_reason(uint32_t c)
+        {
+            if(length(c) == 0) return false;
+            Lit l = clause(c)[0];
+            return value[l] == L_TRUE && reason[l >> 1] == c;
+        }
+
+        /// Watches a newly active clause and assigns or reports what it implies.
+        void attach(uint32_t c)
+        {
+            Lit* L = clause(c);
+            size_t n = length(c);
+            if(n == 0)
+            {
+                if(top_conflict == NONE) top_conflict = c;
+                return;
+            }
+            if(n == 1)
+            {
+                units.push_back(c);
+                if(value[L[0]] == L_FALSE && top_conflict == NONE) top_conflict = c;
+                else if(value[L[0]] == L_UNDEF) assign(L[0], c);
+                return;
+            }
+
+            // Watch the two best literals: true, then unassigned, then false
+            for(size_t k = 0; k < 2; k++)
+            {
+                size_t best = k;
+                for(size_t j = k + 1; j < n; j++)
+                {
+                    if(value[L[j]] > value[L[best]]) best = j;
+                }
+                swap(L[k], L[best]);
+            }
+            watches[L[0]].push_back(c);
+            watches[L[1]].push_back(c);
+            if(value[L[0]] == L_FALSE)
+            {
+                if(top_conflict == NONE) top_conflict = c;
+            }
+            else if(value[L[1]] == L_FALSE && value[L[0]] == L_UNDEF)
+            {
+                assign(L[0], c);
+            }
+        }
+
+        void detach(uint32_t c)
+        {
+            flags[c] &= ~ACTIVE;
+            Lit* L = clause(c);
+            size_t n = length(c);
+            auto unlist = [&](vector<uint32_t>& list) {
+                auto it = find(list.begin(), list.end(), c);
+                if(it == list.end()) return;
+                *it = list.back();
+                list.pop_back();
+            };
+            if(n >= 2)
+            {
+                unlist(watches[L[0]]);
+                unlist(watches[L[1]]);
+            }
+            else if(n == 1)
+            {
+                unlist(units);
+            }
+
+            if(top_conflict != NONE) rollback(0);
+            else if(is_reason(c)) rollback(trail_pos[L[0] >> 1]);
+        }
+
+        /// Visits the clauses watching a literal that became false.
+        uint32_t visit(Lit false_lit, bool core_only)
+        {
+            vector<uint32_t>& ws = watches[false_lit];
+            size_t i = 0, j = 0;
+            while(i < ws.size())
+            {
+                uint32_t c = ws[i++];
+                if(core_only && !(flags[c] & CORE))
+                {
+                    ws[j++] = c;
+                    continue;
+                }
+                Lit* L = clause(c);
+                if(L[0] == false_lit) swap(L[0], L[1]);
+                if(value[L[0]] == L_TRUE)
+                {
+                    ws[j++] = c;
+                    continue;
+                }
+
+                size_t n = length(c), k = 2;
+                while(k < n && value[L[k]] == L_FALSE) k++;
+                if(k < n)
+                {
+                    swap(L[1], L[k]);
+                    watches[L[1]].push_back(c);
+                    continue;
+                }
+
+                ws[j++] = c;
+                if(value[L[0]] == L_FALSE)
+                {
+                    while(i < ws.size()) ws[j++] = ws[i++];
+                    ws.resize(j);
+                    return c;
+                }
+                assign(L[0], c);
+            }
+            ws.resize(j);
+            return NONE;
+        }
+
+        /// Propagates core clauses first; returns a falsified clause or NONE.
+        uint32_t propagate()
+        {
+            while(true)
+            {
+                uint32_t conflict = NONE;
+                if(core_head < trail.size()) conflict = visit(trail[core_head++] ^ 1, true);
+                else if(all_head < trail.size()) conflict = visit(trail[all_head++] ^ 1, false);
+                else return NONE;
+                if(conflict != NONE) return conflict;
+            }
+        }
+
+        void set_core(uint32_t c)
+        {
+            if(flags[c] & CORE) return;
+            flags[c] |= CORE;
+            if(c < n_original) core_clauses++;
+        }
+
+        /// Adds to the core the reasons behind the (false) literals of [b, e).
+        void analyze(const Lit* b, const Lit* e)
+        {
+            for(const Lit* p = b; p != e; p++) seen[*p >> 1] = 1;
+            for(size_t k = trail.size(); k-- > 0;)
+            {
+                uint32_t v = trail[k] >> 1;
+                if(!seen[v]) continue;
+                seen[v] = 0;
+                uint32_t r = reason[v];
+                if(r == NONE) continue;
+                set_core(r);
+                Lit* L = clause(r);
+                for(size_t j = 0; j < length(r); j++)
+                {
+                    if((L[j] >> 1) != v) seen[L[j] >> 1] = 1;
+                }
+            }
+        }
+
+        void mark_core(uint32_t conflict)
+        {
+            set_core(conflict);
+            analyze(clause(conflict), clause(conflict) + length(conflict));
+        }
+
+        /// Assigns the unit clauses again after a rollback and propagates.
+        bool top_level_consistent()
+        {
+            if(units_dirty)
+            {
+                units_dirty = false;
+                for(uint32_t u : units)
+                {
+                    Lit l = clause(u)[0];
+                    if(value[l] == L_FALSE)
+                    {
+                        top_conflict = u;
+                        break;
+                    }
+                    if(value[l] == L_UNDEF) assign(l, u);
+                }
+            }
+            if(top_conflict == NONE) top_conflict = propagate();
+            return top_conflict == NONE;
+        }
+
+        /// Checks that unit propagation refutes the negation of @p lemma, marking what it used.
+        bool rup(const vector<Lit>& lemma)
+        {
+            if(!top_level_consistent())
+            {
+                mark_core(top_conflict);
+                return true;
+            }
+
+            size_t mark = trail.size();
+            for(Lit l : lemma)
+            {
+                if(value[l] == L_TRUE)
+                {
+                    // Already implied at the top level, or a tautology
+                    if(trail_pos[l >> 1] < mark) analyze(&l, &l + 1);
+                    backtrack(mark);
+                    return true;
+                }
+                if(value[l] == L_UNDEF) assign(l ^ 1, NONE);
+            }
+            uint32_t conflict = propagate();
+            if(conflict != NONE) mark_core(conflict);
+            backtrack(mark);
+            return conflict != NONE;
+        }
+
+        bool check_lemma(uint32_t c)
+        {
+            vector<Lit> lemma(clause(c), clause(c) + length(c));
+            if(rup(lemma)) return true;
+
+            // RAT on the pivot: every resolvent with a clause containing its negation
+            Lit p = pivot[c];
+            if(p == NONE) return false;
+            if(occurs.empty())
+            {
+                // No clause is added during the backward pass, so one build serves every check
+                occurs.resize(value.size());
+                for(uint32_t d = 0; d < flags.size(); d++)
+                {
+                    for(size_t j = 0; j < length(d); j++) occurs[clause(d)[j]].push_back(d);
+                }
+            }
+            vector<Lit> resolvent;
+            for(uint32_t d : occurs[p ^ 1])
+            {
+                if(!(flags[d] & ACTIVE)) continue;
+                Lit* L = clause(d);
+
+                resolvent = lemma;
+                for(size_t j = 0; j < length(d); j++)
+                {
+                    if(L[j] != (p ^ 1)) resolvent.push_back(L[j]);
+                }
+                if(!rup(resolvent)) return false;
+                set_core(d);
+            }
+            return true;
+        }
+};
+
+/**
+ * @struct SimplifyStats
+ * @brief What preprocessing removed from a formula
+ */
+struct SimplifyStats
+{
+    size_t vars_before = 0;      ///< Variables occurring in the clauses
+    size_t vars_after = 0;
+    size_t clauses_before = 0;
+    size_t clauses_after = 0;
+    size_t units = 0;            ///< Variables fixed by unit propagation
+    size_t pures = 0;            ///< Variables fixed as pure literals
+    size_t substituted = 0;      ///< Variables replaced by an equivalent literal
+    size_t eliminated = 0;       ///< Variables removed by bounded variable elimination
+    size_t blocked = 0;          ///< Blocked clauses removed
+    size_t subsumed = 0;         ///< Clauses removed as subsumed
+    size_t strengthened = 0;     ///< Literals removed by self-subsuming resolution
+    double time_ms = 0;
+};
+
+/**
+ * @brief Number of distinct variables occurring in a formula
+ */
+size_t count_occurring_vars(const ArenaView& formula)
+{
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    if(!dense.empty()) return dense.size();
+    vector<char> occurs((size_t)n_vars + 1, 0);
+    for(size_t k = 0; k < formula.n_lits; k++) occurs[abs((int64_t)formula.lits[k])] = 1;
+    return (size_t)count(occurs.begin(), occurs.end(), 1);
+}
+
+/**
+ * @brief Simplifies a formula by unit propagation and pure literal elimination
+ *
+ * Unit clauses are propagated to a fixpoint with two watched literals per
+ * clause, over a copy of the clauses from which repeated literals and
+ * tautologies have been dropped. Pure literals are then set true
+ * repeatedly: occurrence counts and lists are built once over the clauses
+ * left, and each clause a pure literal satisfies lowers the counts of its
+ * other literals, which can make their negations pure in turn. Neither
+ * step guesses, so the result is satisfiable exactly when the formula is.
+ *
+ * The clauses left are written to @p out without their false literals and
+ * in DIMACS numbering; the header's variable count is kept. If the budget
+ * runs out, the simplifications made so far are still applied.
+ *
+ * @param fixed Receives the literals set true, units first
+ * @param budget Limits checked periodically; nullptr for none
+ * @return SatResult Unsat (and @p out holds the empty clause) if unit
+ *         propagation finds a conflict, Sat if no clause is left (any
+ *         extension of @p fixed is a model), Unknown otherwise
+ */
+SatResult propagate_units_and_pures(const ArenaView& formula, ClauseArena& out, vector<int32_t>& fixed,
+                                     SimplifyStats& stats, Budget* budget = nullptr)
+{
+    auto start = chrono::high_resolution_clock::now();
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    vector<int32_t> dimacs_var((size_t)n_vars);
+    if(dense.empty()) iota(dimacs_var.begin(), dimacs_var.end(), 1);
+    else for(auto& kv : dense) dimacs_var[kv.second] = kv.first;
+    auto node = [&](int32_t lit) -> uint32_t {
+        int v = (int)abs((int64_t)lit);
+        return 2 * (uint32_t)(dense.empty() ? v - 1 : dense[v]) + (lit < 0);
+    };
+    auto dimacs_lit = [&](uint32_t l) -> int32_t {
+        return l & 1 ? -dimacs_var[l >> 1] : dimacs_var[l >> 1];
+    };
+
+    out.clear();
+    out.var_no = formula.var_no;
+    fixed.clear();
+    stats.clauses_before = formula.size();
+    stats.vars_before = count_occurring_vars(formula);
+    auto finish = [&](SatResult result) {
+        out.clause_no = (int)out.size();
+        stats.clauses_after = out.size();
+        stats.vars_after = count_occurring_vars(out);
+        stats.time_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        return result;
+    };
+    auto refuted = [&]() {
+        out.clear();
+        out.add_clause(nullptr, nullptr);
+        return finish(SatResult::Unsat);
+    };
+
+    // Copy without repeated literals and tautologies
+    size_t n_nodes = 2 * (size_t)n_vars;
+    vector<uint32_t> lits;
+    vector<uint64_t> offsets{0};
+    vector<uint32_t> stamp(n_nodes, 0);
+    lits.reserve(formula.n_lits);
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        uint32_t id = (uint32_t)c + 1;
+        size_t begin = lits.size();
+        bool tautology = false;
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+        {
+            uint32_t l = node(*p);
+            if(stamp[l ^ 1] == id) tautology = true;
+            if(stamp[l] == id) continue;
+            stamp[l] = id;
+            lits.push_back(l);
+        }
+        if(tautology)
+        {
+            lits.resize(begin);
+            continue;
+        }
+        if(lits.size() == begin) return refuted();
+        offsets.push_back(lits.size());
+    }
+    size_t n_clauses = offsets.size() - 1;
+
+    // Unit propagation
+    vector<int8_t> value(n_nodes, 0);
+    vector<uint32_t> trail;
+    vector<vector<uint32_t>> watches(n_nodes);
+    auto assign = [&](uint32_t l) {
+        value[l] = 1;
+        value[l ^ 1] = -1;
+        trail.push_back(l);
+    };
+    vector<uint32_t> n_watches(n_nodes, 0);
+    for(size_t c = 0; c < n_clauses; c++)
+    {
+        if(offsets[c + 1] - offsets[c] < 2) continue;
+        n_watches[lits[offsets[c]]]++;
+        n_watches[lits[offsets[c] + 1]]++;
+    }
+    for(size_t l = 0; l < n_nodes; l++) watches[l].reserve(n_watches[l]);
+    vector<uint32_t>().swap(n_watches);
+    for(size_t c = 0; c < n_clauses; c++)
+    {
+        uint32_t* L = &lits[offsets[c]];
+        if(offsets[c + 1] - offsets[c] >= 2)
+        {
+            watches[L[0]].push_back((uint32_t)c);
+            watches[L[1]].push_back((uint32_t)c);
+        }
+        else if(value[L[0]] == -1)
+        {
+            return refuted();
+        }
+        else if(value[L[0]] == 0)
+        {
+            assign(L[0]);
+        }
+    }
+    for(size_t head = 0; head < trail.size(); head++)
+    {
+        if((head & 0xFFFF) == 0 && budget && budget->exceeded()) break;
+        uint32_t false_lit = trail[head] ^ 1;
+        vector<uint32_t>& ws = watches[false_lit];
+        size_t i = 0, j = 0;
+        bool conflict = false;
+        while(i < ws.size())
+        {
+            uint32_t c = ws[i++];
+            uint32_t* L = &lits[offsets[c]];
+            size_t n = (size_t)(offsets[c + 1] - offsets[c]);
+            if(L[0] == false_lit) swap(L[0], L[1]);
+            if(value[L[0]] == 1)
+            {
+                ws[j++] = c;
+                continue;
+            }
+            size_t k = 2;
+            while(k < n && value[L[k]] == -1) k++;
+            if(k < n)
+            {
+                swap(L[1], L[k]);
+                watches[L[1]].push_back(c);
+                continue;
+            }
+            ws[j++] = c;
+            if(value[L[0]] == -1)
+            {
+                conflict = true;
+                break;
+            }
+            assign(L[0]);
+        }
+        if(conflict) return refuted();
+        while(i < ws.size()) ws[j++] = ws[i++];
+        ws.resize(j);
+    }
+    vector<vector<uint32_t>>().swap(watches);
+    stats.units = trail.size();
+
+    // Pure literals, over the clauses propagation left unsatisfied
+    vector<char> alive(n_clauses, 1);
+    vector<uint64_t> first(n_nodes + 1, 0);
+    for(size_t c = 0; c < n_clauses; c++)
+    {
+        for(uint64_t k = offsets[c]; k < offsets[c + 1]; k++)
+        {
+            if(value[lits[k]] == 1) alive[c] = 0;
+        }
+        if(!alive[c]) continue;
+        for(uint64_t k = offsets[c]; k < offsets[c + 1]; k++)
+        {
+            if(value[lits[k]] == 0) first[lits[k] + 1]++;
+        }
+    }
+    vector<uint64_t> count(n_nodes);
+    for(size_t l = 0; l < n_nodes; l++)
+    {
+        count[l] = first[l + 1];
+        first[l + 1] += first[l];
+    }
+    vector<uint32_t> occurs(first[n_nodes]);
+    vector<uint64_t> fill(first.begin(), first.end() - 1);
+    for(size_t c = 0; c < n_clauses; c++)
+    {
+        if(!alive[c]) continue;
+        for(uint64_t k = offsets[c]; k < offsets[c + 1]; k++)
+        {
+            if(value[lits[k]] == 0) occurs[fill[lits[k]]++] = (uint32_t)c;
+        }
+    }
+    vector<uint64_t>().swap(fill);
+
+    vector<uint32_t> pure;
+    for(uint32_t l = 0; l < n_nodes; l++)
+    {
+        if(value[l] == 0 && count[l] > 0 && count[l ^ 1] == 0) pure.push_back(l);
+    }
+    while(!pure.empty() && !(budget && (pure.size() & 0xFFF) == 0 && budget->exceeded()))
+    {
+        uint32_t l = pure.back();
+        pure.pop_back();
+        if(value[l] != 0) continue;
+        assign(l);
+        for(uint64_t o = first[l]; o < first[l + 1]; o++)
+        {
+            uint32_t c = occurs[o];
+            if(!alive[c]) continue;
+            alive[c] = 0;
+            for(uint64_t k = offsets[c]; k < offsets[c + 1]; k++)
+            {
+                uint32_t m = lits[k];
+                if(value[m] == 0 && --count[m] == 0 && count[m ^ 1] > 0) pure.push_back(m ^ 1);
+            }
+        }
+    }
+    stats.pures = trail.size() - stats.units;
+
+    for(uint32_t l : trail) fixed.push_back(dimacs_lit(l));
+    vector<int32_t> clause;
+    for(size_t c = 0; c < n_clauses; c++)
+    {
+        if(!alive[c]) continue;
+        clause.clear();
+        for(uint64_t k = offsets[c]; k < offsets[c + 1]; k++)
+        {
+            if(value[lits[k]] == 0) clause.push_back(dimacs_lit(lits[k]));
+        }
+        out.add_clause(clause.data(), clause.data() + clause.size());
+    }
+    return finish(out.size() == 0 ? SatResult::Sat : SatResult::Unknown);
+}
+
+/**
+ * @brief Replaces equivalent literals by one representative
+ *
+ * The binary clauses give an implication graph (see solve_2sat()) whose
+ * strongly connected components are classes of equivalent literals. Every
+ * literal is replaced by the literal of its class with the smallest
+ * variable, so the negated class maps to the negation of the same literal.
+ * The clauses are rewritten without repeated literals, and those that
+ * become tautologies or copies of an earlier clause are dropped. Rewriting
+ * can turn longer clauses into binary ones that reveal more equivalences,
+ * so this repeats until no variable is replaced.
+ *
+ * @param out Receives the clauses in DIMACS numbering; the header's
+ *            variable count is kept
+ * @param mapping Receives, per variable replaced, the variable and the
+ *                literal it equals in @p out
+ * @param budget Limits checked between and within rounds; nullptr for
+ *               none. When they run out, the rounds done are kept.
+ * @return SatResult Unsat (and @p out holds the empty clause) if a literal
+ *         is equivalent to its negation, Unknown otherwise
+ */
+SatResult substitute_equivalences(const ArenaView& formula, ClauseArena& out, vector<pair<int32_t, int32_t>>& mapping,
+                                  SimplifyStats& stats, Budget* budget = nullptr)
+{
+    out.clear();
+    out.var_no = formula.var_no;
+    for(size_t c = 0; c < formula.size(); c++) out.add_clause(formula.begin(c), formula.end(c));
+    out.clause_no = (int)out.size();
+    mapping.clear();
+    unordered_map<int32_t, int32_t> replaced;   // DIMACS variable -> literal, as of its round
+
+    while(!(budget && budget->exceeded()))
+    {
+        unordered_map<int, int> dense;
+        int n_vars = number_variables(out, dense);
+        vector<int32_t> dimacs_var((size_t)n_vars);
+        if(dense.empty()) iota(dimacs_var.begin(), dimacs_var.end(), 1);
+        else for(auto& kv : dense) dimacs_var[kv.second] = kv.first;
+        auto node = [&](int32_t lit) -> uint32_t {
+            int v = (int)abs((int64_t)lit);
+            return 2 * (uint32_t)(dense.empty() ? v - 1 : dense[v]) + (lit < 0);
+        };
+        auto dimacs_lit = [&](uint32_t l) -> int32_t {
+            return l & 1 ? -dimacs_var[l >> 1] : dimacs_var[l >> 1];
+        };
+
+        // Implication graph of the binary clauses
+        size_t n_nodes = 2 * (size_t)n_vars;
+        vector<uint64_t> first(n_nodes + 1, 0);
+        for(size_t c = 0; c < out.size(); c++)
+        {
+            if(out.length(c) != 2) continue;
+            uint32_t a = node(out.begin(c)[0]), b = node(out.begin(c)[1]);
+            if(a == b || a == (b ^ 1)) continue;
+            first[(a ^ 1) + 1]++;
+            first[(b ^ 1) + 1]++;
+        }
+        for(size_t u = 0; u < n_nodes; u++) first[u + 1] += first[u];
+        vector<uint32_t> target(first[n_nodes]);
+        {
+            vector<uint64_t> next(first.begin(), first.end() - 1);
+            for(size_t c = 0; c < out.size(); c++)
+            {
+                if(out.length(c) != 2) continue;
+                uint32_t a = node(out.begin(c)[0]), b = node(out.begin(c)[1]);
+                if(a == b || a == (b ^ 1)) continue;
+                target[next[a ^ 1]++] = b;
+                target[next[b ^ 1]++] = a;
+            }
+        }
+        vector<uint32_t> comp;
+        if(!strongly_connected_components(first, target, comp, budget)) break;
+
+        // Representative of each class: its literal of smallest variable
+        const uint32_t NONE = 0xFFFFFFFFu;
+        vector<uint32_t> representative(n_nodes, NONE);
+        for(uint32_t u = 0; u < n_nodes; u++)
+        {
+            if((u & 1) == 0 && comp[u] == comp[u + 1])
+            {
+                out.clear();
+                out.add_clause(nullptr, nullptr);
+                out.clause_no = 1;
+                return SatResult::Unsat;
+            }
+            if(representative[comp[u]] == NONE) representative[comp[u]] = u;
+        }
+        size_t round_replaced = 0;
+        for(uint32_t v = 0; v < (uint32_t)n_vars; v++)
+        {
+            uint32_t r = representative[comp[2 * v]];
+            if(r == 2 * v) continue;
+            replaced[dimacs_var[v]] = dimacs_lit(r);
+            round_replaced++;
+        }
+        if(round_replaced == 0) break;
+        stats.substituted += round_replaced;
+
+        // Rewrite, then drop copies: equal clauses are adjacent once sorted by hash
+        ClauseArena rewritten;
+        rewritten.var_no = out.var_no;
+        vector<uint32_t> stamp(n_nodes, 0);
+        vector<int32_t> clause;
+        vector<pair<uint64_t, uint32_t>> keys;
+        for(size_t c = 0; c < out.size(); c++)
+        {
+            clause.clear();
+            bool tautology = false;
+            for(const int32_t* p = out.begin(c); p != out.end(c); p++)
+            {
+                uint32_t l = representative[comp[node(*p)]];
+                if(stamp[l ^ 1] == c + 1) tautology = true;
+                if(stamp[l] == c + 1) continue;
+                stamp[l] = (uint32_t)c + 1;
+                clause.push_back(dimacs_lit(l));
+            }
+            if(tautology) continue;
+            sort(clause.begin(), clause.end());
+            uint64_t h = hash_bytes(HASH_SEED, clause.data(), clause.size() * sizeof(int32_t));
+            keys.push_back({hash_finish(h, clause.size()), (uint32_t)rewritten.size()});
+            rewritten.add_clause(clause.data(), clause.data() + clause.size());
+        }
+        sort(keys.begin(), keys.end());
+        vector<char> copy(rewritten.size(), 0);
+        for(size_t i = 0; i < keys.size(); i++)
+        {
+            if(copy[keys[i].second]) continue;
+            for(size_t j = i + 1; j < keys.size() && keys[j].first == keys[i].first; j++)
+            {
+                uint32_t a = keys[i].second, b = keys[j].second;
+                if(!copy[b] && rewritten.length(a) == rewritten.length(b) &&
+                   equal(rewritten.begin(a), rewritten.end(a), rewritten.begin(b)))
+                {
+                    copy[b] = 1;
+                }
+            }
+        }
+        out.clear();
+        for(size_t c = 0; c < rewritten.size(); c++)
+        {
+            if(!copy[c]) out.add_clause(rewritten.begin(c), rewritten.end(c));
+        }
+        out.clause_no = (int)out.size();
+    }
+
+    // Representatives of earlier rounds may have been replaced later
+    for(auto& kv : replaced)
+    {
+        int32_t lit = kv.second;
+        for(auto it = replaced.find(abs(lit)); it != replaced.end(); it = replaced.find(abs(lit)))
+        {
+            lit = lit < 0 ? -it->second : it->second;
+        }
+        mapping.push_back({kv.first, lit});
+    }
+    sort(mapping.begin(), mapping.end());
+    return SatResult::Unknown;
+}
+
+/// Variables whose occurrence counts multiply to more than this are not eliminated.
+const size_t ELIM_PRODUCT_LIMIT = 1 << 12;
+
+/// Longest resolvent variable elimination may add.
+const size_t ELIM_RESOLVENT_LIMIT = 20;
+
+/// Longest occurrence list scanned for subsumption and blocked clauses.
+const size_t OCC_SCAN_LIMIT = 1000;
+
+/**
+ * @class Eliminator
+ * @brief SatELite-style preprocessor: subsumption, blocked clause elimination
+ *        and bounded variable elimination
+ *
+ * Clauses live in one literal pool and are found through full occurrence
+ * lists, one per literal, which are cleaned of removed clauses lazily. Each
+ * clause carries a 64-bit signature of its variables, so most candidates
+ * for subsumption are rejected without reading their literals.
+ *
+ * run() works in three stages:
+ * - backward subsumption: every clause removes the clauses it subsumes and,
+ *   when it matches one but for a single negated literal, strengthens that
+ *   clause by removing the literal (self-subsuming resolution);
+ * - blocked clause elimination: a clause is removed when all its
+ *   resolvents on one of its literals are tautologies;
+ * - bounded variable elimination: variables are taken from a priority
+ *   queue ordered by |occ(x)| * |occ(-x)| - |occ(x)| - |occ(-x)|, and one
+ *   is eliminated by clause distribution when that adds no more resolvents,
+ *   none longer than ELIM_RESOLVENT_LIMIT, than the clauses it removes. New
+ *   resolvents are checked for subsumption, and the variables of changed
+ *   clauses go back into the queue.
+ * Unit clauses that appear along the way are propagated.
+ *
+ * Removed clauses that a model of the result may violate are kept, with
+ * the literal that repairs them first, on a reconstruction stack (see
+ * extract()). The budget is checked throughout; when it runs out, run()
+ * returns with the formula simplified as far as it got.
+ */
+class Eliminator
+{
+    public:
+        /**
+         * @brief Loads a formula, dropping repeated literals and tautologies
+         *
+         * Sparse variable numbers are renumbered (see number_variables()).
+         */
+        Eliminator(const ArenaView& formula) : var_no(formula.var_no)
+        {
+            unordered_map<int, int> dense;
+            n_vars = number_variables(formula, dense);
+            dimacs_var.resize((size_t)n_vars);
+            if(dense.empty()) iota(dimacs_var.begin(), dimacs_var.end(), 1);
+            else for(auto& kv : dense) dimacs_var[kv.second] = kv.first;
+
+            size_t n_nodes = 2 * (size_t)n_vars;
+            value.assign(n_nodes, 0);
+            stamp.assign(n_nodes, 0);
+            eliminated.assign((size_t)n_vars, 0);
+            touched.assign((size_t)n_vars, 0);
+            occ.resize(n_nodes);
+            n_occ.assign(n_nodes, 0);
+            lits.reserve(formula.n_lits);
+            for(size_t k = 0; k < formula.n_lits; k++)
+            {
+                int v = (int)abs((int64_t)formula.lits[k]);
+                n_occ[2 * (size_t)(dense.empty() ? v - 1 : dense[v]) + (formula.lits[k] < 0)]++;
+            }
+            for(size_t l = 0; l < n_nodes; l++) occ[l].reserve(n_occ[l]);
+            n_occ.assign(n_nodes, 0);
+            clauses.reserve(formula.size());
+            subsume_queue.reserve(formula.size());
+
+            vector<Lit> clause;
+            for(size_t c = 0; c < formula.size(); c++)
+            {
+                clause.clear();
+                stamp_id++;
+                bool tautology = false;
+                for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+                {
+                    int v = (int)abs((int64_t)*p);
+                    Lit l = 2 * (Lit)(dense.empty() ? v - 1 : dense[v]) + (*p < 0);
+                    if(stamp[l ^ 1] == stamp_id) tautology = true;
+                    if(stamp[l] == stamp_id) continue;
+                    stamp[l] = stamp_id;
+                    clause.push_back(l);
+                }
+                if(!tautology) add_clause(clause);
+            }
+            for(uint32_t v : touched_list) touched[v] = 0;
+            touched_list.clear();
+        }
+
+        /**
+         * @brief Simplifies the formula
+         * @param stats Receives the counts of what was removed
+         * @param budget Limits checked throughout; nullptr for none
+         * @return SatResult Unsat if the formula was refuted, Sat if no
+         *         clause is left, Unknown otherwise
+         */
+        SatResult run(SimplifyStats& stats, Budget* budget = nullptr)
+        {
+            this->budget = budget;
+            this->stats = &stats;
+            propagate();
+            subsume();
+            if(!unsat) eliminate_blocked();
+            if(!unsat) eliminate_variables();
+            if(unsat) return SatResult::Unsat;
+            return n_alive == 0 ? SatResult::Sat : SatResult::Unknown;
+        }
+
+        /**
+         * @brief Writes out the simplified formula and the reconstruction stack
+         *
+         * Both are in DIMACS numbering. Each entry of @p stack is a removed
+         * clause whose first literal repairs it; a model of @p out extends
+         * to a model of the original formula by going through the stack
+         * from the last entry to the first and setting that literal true
+         * in every entry the assignment so far does not satisfy (variables
+         * not yet assigned count as false).
+         */
+        void extract(ClauseArena& out, ClauseArena& stack) const
+        {
+            auto dimacs_lit = [&](Lit l) -> int32_t {
+                return l & 1 ? -dimacs_var[l >> 1] : dimacs_var[l >> 1];
+            };
+            vector<int32_t> clause;
+            out.clear();
+            out.var_no = stack.var_no = var_no;
+            if(unsat)
+            {
+                out.add_clause(nullptr, nullptr);
+            }
+            else
+            {
+                for(size_t c = 0; c < clauses.size(); c++)
+                {
+                    if(clauses[c].removed) continue;
+                    clause.clear();
+                    for(uint32_t k = 0; k < clauses[c].len; k++) clause.push_back(dimacs_lit(lits[clauses[c].start + k]));
+                    out.add_clause(clause.data(), clause.data() + clause.size());
+                }
+            }
+            out.clause_no = (int)out.size();
+
+            stack.clear();
+            for(size_t e = 0; e + 1 < stack_offsets.size(); e++)
+            {
+                clause.clear();
+                for(uint64_t k = stack_offsets[e]; k < stack_offsets[e + 1]; k++) clause.push_back(dimacs_lit(stack_lits[k]));
+                stack.add_clause(clause.data(), clause.data() + clause.size());
+            }
+            stack.clause_no = (int)stack.size();
+        }
+
+    private:
+        typedef uint32_t Lit;   ///< 2*var + 1 if negated, var counted from 0
+
+        /// Everything about a clause but its literals, in one place for locality.
+        struct ClauseInfo
+        {
+            uint64_t start;     ///< First literal in the pool
+            uint64_t sig;       ///< Bit (var % 64) of each variable
+            uint32_t len;       ///< Number of literals
+            bool removed;
+            bool queued;        ///< Waiting in subsume_queue
+        };
+
+        int var_no;
+        int n_vars = 0;
+        vector<int32_t> dimacs_var;             ///< Per variable
+
+        vector<Lit> lits;                       ///< Literal pool
+        vector<ClauseInfo> clauses;
+        size_t n_alive = 0;
+        vector<vector<uint32_t>> occ;           ///< Per literal: clauses containing it, maybe removed
+        vector<uint32_t> n_occ;                 ///< Per literal: clauses containing it, not removed
+
+        vector<int8_t> value;                   ///< Per literal: fixed true 1, false -1
+        vector<char> eliminated;                ///< Per variable
+        vector<uint32_t> stamp;                 ///< Per literal, for set operations on clauses
+        uint32_t stamp_id = 0;
+        vector<Lit> units;
+        vector<uint32_t> subsume_queue;
+        vector<char> touched;                   ///< Per variable: occurrences changed
+        vector<uint32_t> touched_list;
+
+        vector<uint32_t> pos, neg;              ///< Scratch for try_eliminate()
+        vector<Lit> resolvent;
+
+        vector<Lit> stack_lits;                 ///< Reconstruction stack, see extract()
+        vector<uint64_t> stack_offsets{0};
+
+        bool unsat = false;
+        bool stopped = false;
+        uint64_t ticks = 0;
+        Budget* budget = nullptr;
+        SimplifyStats* stats = nullptr;
+
+        bool out_of_budget()
+        {
+            if(!stopped && budget && (++ticks & 1023) == 0) stopped = budget->exceeded();
+            return stopped;
+        }
+
+        void touch(Lit l)
+        {
+            if(touched[l >> 1]) return;
+            touched[l >> 1] = 1;
+            touched_list.push_back(l >> 1);
+        }
+
+        uint64_t signature(uint32_t c) const
+        {
+            uint64_t s = 0;
+            for(uint32_t k = 0; k < clauses[c].len; k++) s |= 1ull << ((lits[clauses[c].start + k] >> 1) & 63);
+            return s;
+        }
+
+        void add_clause(const vector<Lit>& clause)
+        {
+            uint32_t c = (uint32_t)clauses.size();
+            clauses.push_back(ClauseInfo{lits.size(), 0, (uint32_t)clause.size(), false, true});
+            lits.insert(lits.end(), clause.begin(), clause.end());
+            clauses[c].sig = signature(c);
+            subsume_queue.push_back(c);
+            n_alive++;
+            for(Lit l : clause)
+            {
+                occ[l].push_back(c);
+                n_occ[l]++;
+                touch(l);
+            }
+            if(clause.empty()) unsat = true;
+            else if(clause.size() == 1) units.push_back(clause[0]);
+        }
+
+        void remove_clause(uint32_t c)
+        {
+            clauses[c].removed = true;
+            n_alive--;
+            for(uint32_t k = 0; k < clauses[c].len; k++)
+            {
+                n_occ[lits[clauses[c].start + k]]--;
+                touch(lits[clauses[c].start + k]);
+            }
+        }
+
+        /// Removes literal @p l from clause @p c.
+        void strengthen(uint32_t c, Lit l)
+        {
+            Lit* L = &lits[clauses[c].start];
+            uint32_t k = 0;
+            while(L[k] != l) k++;
+            L[k] = L[--clauses[c].len];
+            clauses[c].sig = signature(c);
+            n_occ[l]--;
+
+            vector<uint32_t>& list = occ[l];
+            auto it = find(list.begin(), list.end(), c);
+            if(it != list.end())
+            {
+                *it = list.back();
+                list.pop_back();
+            }
+            touch(l);
+            if(!clauses[c].queued)
+            {
+                clauses[c].queued = true;
+                subsume_queue.push_back(c);
+            }
+            if(clauses[c].len == 0) unsat = true;
+            else if(clauses[c].len == 1) units.push_back(L[0]);
+        }
+
+        /// The clauses containing @p l, after dropping removed ones from the list.
+        vector<uint32_t>& occurrences(Lit l)
+        {
+            vector<uint32_t>& list = occ[l];
+            list.erase(remove_if(list.begin(), list.end(), [&](uint32_t c) { return clauses[c].removed != 0; }), list.end());
+            return list;
+        }
+
+        void push_stack(uint32_t c, Lit witness)
+        {
+            stack_lits.push_back(witness);
+            for(uint32_t k = 0; k < clauses[c].len; k++)
+            {
+                if(lits[clauses[c].start + k] != witness) stack_lits.push_back(lits[clauses[c].start + k]);
+            }
+            stack_offsets.push_back(stack_lits.size());
+        }
+
+        void push_stack_unit(Lit l)
+        {
+            stack_lits.push_back(l);
+            stack_offsets.push_back(stack_lits.size());
+        }
+
+        /// Fixes unit literals, removing the clauses they satisfy and their negations.
+        void propagate()
+        {
+            vector<uint32_t> list;
+            while(!units.empty() && !unsat)
+            {
+                Lit l = units.back();
+                units.pop_back();
+                if(value[l] == 1) continue;
+                if(value[l] == -1)
+                {
+                    unsat = true;
+                    return;
+                }
+                value[l] = 1;
+                value[l ^ 1] = -1;
+                push_stack_unit(l);
+                stats->units++;
+
+                for(uint32_t c : occurrences(l)) remove_clause(c);
+                list = occurrences(l ^ 1);
+                for(uint32_t c : list)
+                {
+                    if(!clauses[c].removed) strengthen(c, l ^ 1);
+                }
+            }
+        }
+
+        /// Backward subsumption and strengthening by every clause in the queue.
+        void subsume()
+        {
+            vector<uint32_t> candidates;
+            while(!subsume_queue.empty() && !unsat && !out_of_budget())
+            {
+                uint32_t c = subsume_queue.back();
+                subsume_queue.pop_back();
+                clauses[c].queued = false;
+                if(clauses[c].removed) continue;
+
+                // Every clause c subsumes or strengthens contains its least frequent variable
+                Lit best = lits[clauses[c].start];
+                size_t best_n = SIZE_MAX;
+                for(uint32_t k = 0; k < clauses[c].len; k++)
+                {
+                    Lit l = lits[clauses[c].start + k];
+                    size_t n = n_occ[l] + n_occ[l ^ 1];
+                    if(n < best_n)
+                    {
+                        best = l;
+                        best_n = n;
+                    }
+                }
+                if(best_n > OCC_SCAN_LIMIT) continue;
+
+                stamp_id++;
+                for(uint32_t k = 0; k < clauses[c].len; k++) stamp[lits[clauses[c].start + k]] = stamp_id;
+                candidates = occurrences(best);
+                const vector<uint32_t>& negated = occurrences(best ^ 1);
+                candidates.insert(candidates.end(), negated.begin(), negated.end());
+                for(uint32_t d : candidates)
+                {
+                    if(d == c || clauses[d].removed || clauses[d].len < clauses[c].len || (clauses[c].sig & ~clauses[d].sig) != 0) continue;
+                    uint32_t matched = 0, flipped = 0;
+                    Lit flip = 0;
+                    for(uint32_t k = 0; k < clauses[d].len && flipped <= 1; k++)
+                    {
+                        Lit m = lits[clauses[d].start + k];
+                        if(stamp[m] == stamp_id)
+                        {
+                            matched++;
+                        }
+                        else if(stamp[m ^ 1] == stamp_id)
+                        {
+                            flipped++;
+                            flip = m;
+                        }
+                    }
+                    if(flipped == 0 && matched == clauses[c].len)
+                    {
+                        remove_clause(d);
+                        stats->subsumed++;
+                    }
+                    else if(flipped == 1 && matched + 1 == clauses[c].len)
+                    {
+                        strengthen(d, flip);
+                        stats->strengthened++;
+                    }
+                }
+                propagate();
+            }
+        }
+
+        void eliminate_blocked()
+        {
+            vector<uint32_t> with_l;
+            for(Lit l = 0; l < 2 * (Lit)n_vars && !out_of_budget(); l++)
+            {
+                if(value[l] != 0) continue;
+                if(n_occ[l] == 0 || n_occ[l ^ 1] > OCC_SCAN_LIMIT) continue;
+                const vector<uint32_t>& negated = occurrences(l ^ 1);
+                with_l = occurrences(l);
+                for(uint32_t c : with_l)
+                {
+                    stamp_id++;
+                    for(uint32_t k = 0; k < clauses[c].len; k++) stamp[lits[clauses[c].start + k]] = stamp_id;
+
+                    // Blocked on l if every resolvent with a clause containing -l is a tautology
+                    bool blocked = true;
+                    for(uint32_t d : negated)
+                    {
+                        if(clauses[d].removed) continue;
+                        bool tautology = false;
+                        for(uint32_t k = 0; k < clauses[d].len && !tautology; k++)
+                        {
+                            Lit m = lits[clauses[d].start + k];
+                            tautology = (m != (l ^ 1) && stamp[m ^ 1] == stamp_id);
+                        }
+                        if(!tautology)
+                        {
+                            blocked = false;
+                            break;
+                        }
+                    }
+                    if(!blocked) continue;
+                    push_stack(c, l);
+                    remove_clause(c);
+                    stats->blocked++;
+                }
+            }
+        }
+
+        /// Resolves clauses @p p (with x) and @p q (with -x); false for a tautology.
+        bool resolve(uint32_t p, uint32_t q, Lit x, vector<Lit>& out)
+        {
+            out.clear();
+            stamp_id++;
+            for(uint32_t k = 0; k < clauses[p].len; k++)
+            {
+                Lit m = lits[clauses[p].start + k];
+                if(m == x) continue;
+                stamp[m] = stamp_id;
+                out.push_back(m);
+            }
+            for(uint32_t k = 0; k < clauses[q].len; k++)
+            {
+                Lit m = lits[clauses[q].start + k];
+                if(m == (x ^ 1) || stamp[m] == stamp_id) continue;
+                if(stamp[m ^ 1] == stamp_id) return false;
+                out.push_back(m);
+            }
+            return true;
+        }
+
+        int64_t elimination_cost(uint32_t v)
+        {
+            int64_t p = n_occ[2 * v], n = n_occ[2 * v + 1];
+            return p * n - p - n;
+        }
+
+        bool try_eliminate(uint32_t v)
+        {
+            Lit x = 2 * v;
+            if(n_occ[x] + n_occ[x ^ 1] == 0 || (size_t)n_occ[x] * n_occ[x ^ 1] > ELIM_PRODUCT_LIMIT) return false;
+            pos = occurrences(x);
+            neg = occurrences(x ^ 1);
+
+            size_t n_resolvents = 0;
+            for(uint32_t p : pos)
+            {
+                for(uint32_t q : neg)
+                {
+                    if(!resolve(p, q, x, resolvent)) continue;
+                    if(++n_resolvents > pos.size() + neg.size() || resolvent.size() > ELIM_RESOLVENT_LIMIT) return false;
+                }
+            }
+
+            // Keep the smaller side: its clauses repair x, the default being the other sign
+            bool keep_pos = pos.size() <= neg.size();
+            for(uint32_t c : keep_pos ? pos : neg) push_stack(c, keep_pos ? x : x ^ 1);
+            push_stack_unit(keep_pos ? x ^ 1 : x);
+
+            for(uint32_t p : pos)
+            {
+                for(uint32_t q : neg)
+                {
+                    if(resolve(p, q, x, resolvent)) add_clause(resolvent);
+                }
+            }
+            for(uint32_t c : pos) remove_clause(c);
+            for(uint32_t c : neg) remove_clause(c);
+            eliminated[v] = 1;
+            stats->eliminated++;
+            return true;
+        }
+
+        void eliminate_variables()
+        {
+            typedef pair<int64_t, uint32_t> Entry;
+            priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+            auto queue_touched = [&]() {
+                for(uint32_t v : touched_list)
+                {
+                    touched[v] = 0;
+                    if(!eliminated[v] && value[2 * v] == 0) heap.push(Entry(elimination_cost(v), v));
+                }
+                touched_list.clear();
+            };
+            for(uint32_t v : touched_list) touched[v] = 0;
+            touched_list.clear();
+            for(uint32_t v = 0; v < (uint32_t)n_vars; v++)
+            {
+                if(value[2 * v] == 0 && n_occ[2 * v] + n_occ[2 * v + 1] > 0) heap.push(Entry(elimination_cost(v), v));
+            }
+
+            while(!heap.empty() && !unsat && !out_of_budget())
+            {
+                Entry top = heap.top();
+                heap.pop();
+                uint32_t v = top.second;
+                if(eliminated[v] || value[2 * v] != 0) continue;
+                int64_t cost = elimination_cost(v);
+                if(cost > top.first)
+                {
+                    heap.push(Entry(cost, v));
+                    continue;
+                }
+                if(!try_eliminate(v)) continue;
+                subsume();
+                queue_touched();
+            }
+        }
+};
+
+/**
+ * @struct CnfAnalysis
+ * @brief Result of analyzing one CNF file
+ */
+struct CnfAnalysis
+{
+    string path;            ///< Full path of the analyzed file (or of its archive)
+    string member;          ///< Path inside the archive; empty for plain files
+    bool ans = false;       ///< True if every clause is valid (tautology)
+    int n1 = 0;             ///< Number of valid clauses
+    int n2 = 0;             ///< Number of invalid clauses
+    double time_ms = 0;     ///< Wall-clock time of the analysis
+    FileResources usage;    ///< CPU time and memory used by the analysis
+    bool cached = false;    ///< Served from the result cache instead of analyzed
+    string status;          ///< "TIMEOUT" or "MEMOUT" if a limit stopped the analysis
+    string sat;             ///< "SAT", "UNSAT" or "UNKNOWN" when satisfiability was decided
+    string sat_method;      ///< Procedures that decided it: "ProbSAT", or "Horn", "renamable Horn", "2-SAT" and/or "CDCL"
+    string horn_class;      ///< "Horn", "renamable Horn" or "not Horn", when it was determined
+    size_t components = 0;  ///< Connected components (groups of clauses sharing no variable)
+    string component_sizes; ///< Components per variable count, see size_histogram()
+    CnfStats shape;         ///< Clause-shape statistics, when the formula was loaded (all zero otherwise)
+    SolverStats solver;     ///< Search statistics of the satisfiability check
+    string fingerprint;     ///< Exact fingerprint (see CnfFingerprint), when deduplicating
+    string duplicate_of;    ///< File whose result was reused for this duplicate
+};
+
+/**
+ * @brief Result column text: the limit that was hit, or Valid / Invalid
+ */
+string result_text(const CnfAnalysis& r)
+{
+    if (!r.status.empty()) return r.status;
+    return r.ans ? "Valid" : "Invalid";
+}
+
+/**
+ * @struct AnalysisOptions
+ * @brief Settings that apply to the analysis of every file
+ */
+struct AnalysisOptions
+{
+    Limits limits;              ///< Time and memory limits per file
+    bool use_sidecar = true;    ///< Read fresh binary sidecars instead of parsing
+    bool solve = false;         ///< Also decide satisfiability (see decide_satisfiability())
+    double solve_time_s = 0;    ///< Time budget of the search per file; 0 for only the file limit
+    double probe_time_s = 0.1;  ///< Time budget of the local search probe per file; 0 to skip it
+};
+
+/**
+ * @brief Counts valid clauses of a loaded formula, split across threads
+ *
+ * The clauses are cut into @p threads equal ranges, each counted with its
+ * own TautologyDetector.
+ */
+int cnf_validcno_arena(const ArenaView& arena, unsigned threads, Budget* budget)
+{
+    size_t ranges = max<size_t>(1, min<size_t>(threads, arena.size() / 65536));
+    vector<int> partial(ranges);
+    parallel_for(ranges, threads, [&](size_t k) {
+        partial[k] = count_valid_clauses(arena, arena.size() * k / ranges, arena.size() * (k + 1) / ranges, budget);
+    });
+
+    int valid_clause_no = 0;
+    for(int n : partial) valid_clause_no += n;
+    return valid_clause_no;
+}
+
+/**
+ * @brief Size of a file for sizing buffers, or 0 if it is compressed or missing
+ */
+uintmax_t plain_file_size(const string& filepath)
+{
+    error_code ec;
+    uintmax_t size = fs::file_size(filepath, ec);
+    return ec || detect_compression(filepath) != Compression::None ? 0 : size;
+}
+
+/**
+ * @struct SatVerdict
+ * @brief Outcome of deciding one formula or one of its components
+ */
+struct SatVerdict
+{
+    SatResult result = SatResult::Unknown;
+    string method;          ///< See CnfAnalysis::sat_method
+    string horn_class;      ///< See CnfAnalysis::horn_class
+    SolverStats stats;
+};
+
+/**
+ * @brief Decides whether one formula is satisfiable
+ *
+ * The formula is first classified: Horn formulas are decided in linear time
+ * by solve_horn(), formulas with no clause longer than two literals by
+ * solve_2sat(), and renamable-Horn formulas (see find_horn_renaming()) by
+ * solve_horn() under the renaming. Only the rest go to CdclSolver, within
+ * the search time budget of @p options. All stop when the file's budget
+ * runs out.
+ */
+SatVerdict solve_formula(const ArenaView& formula, const AnalysisOptions& options, Budget& budget)
+{
+    SatVerdict v;
+    size_t max_length = 0;
+    for(size_t c = 0; c < formula.size(); c++) max_length = max(max_length, formula.length(c));
+
+    vector<char> flip;
+    auto start = chrono::steady_clock::now();
+    if(is_horn(formula))
+    {
+        v.horn_class = v.method = "Horn";
+        v.result = solve_horn(formula, nullptr, &budget);
+    }
+    else if(max_length <= 2)
+    {
+        // A 2-CNF formula is its own renaming problem
+        v.result = solve_2sat(formula, &budget);
+        v.method = "2-SAT";
+        if(v.result != SatResult::Unknown) v.horn_class = v.result == SatResult::Sat ? "renamable Horn" : "not Horn";
+    }
+    else if(find_horn_renaming(formula, flip, &budget))
+    {
+        v.horn_class = v.method = "renamable Horn";
+        v.result = solve_horn(formula, &flip, &budget);
+    }
+    else
+    {
+        if(budget.outcome().empty()) v.horn_class = "not Horn";
+        CdclSolver solver(formula);
+        v.result = solver.solve(&budget, options.solve_time_s);
+        v.method = "CDCL";
+        v.stats = solver.stats;
+    }
+    if(v.method != "CDCL") v.stats.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return v;
+}
+
+/**
+ * @class UnionFind
+ * @brief Disjoint sets over 0..n-1, with union by size and path halving
+ */
+class UnionFind
+{
+    public:
+        explicit UnionFind(size_t n) : parent(n), size(n, 1)
+        {
+            iota(parent.begin(), parent.end(), 0u);
+        }
+
+        uint32_t find(uint32_t x)
+        {
+            while(parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }
+
+        void unite(uint32_t a, uint32_t b)
+        {
+            a = find(a);
+            b = find(b);
+            if(a == b) return;
+            if(size[a] < size[b]) swap(a, b);
+            parent[b] = a;
+            size[a] += size[b];
+        }
+
+    private:
+        vector<uint32_t> parent;
+        vector<uint32_t> size;
+};
+
+/**
+ * @struct FormulaComponents
+ * @brief Partition of a formula's clauses into groups that share no variable
+ */
+struct FormulaComponents
+{
+    vector<uint32_t> of_clause;   ///< Component of each clause
+    vector<size_t> vars;          ///< Variables in each component
+    vector<size_t> clauses;       ///< Clauses in each component
+
+    size_t count() const
+    {
+        return vars.size();
+    }
+};
+
+/**
+ * @brief Finds the connected components of the variable-clause graph
+ *
+ * Variables of the same clause are merged in a UnionFind, in one pass over
+ * the literals; a second pass numbers the components in order of first
+ * occurrence. An empty clause is a component of its own.
+ */
+FormulaComponents find_components(const ArenaView& formula)
+{
+    const uint32_t NONE = 0xFFFFFFFFu;
+    unordered_map<int, int> dense;
+    int n_vars = number_variables(formula, dense);
+    auto var_of = [&](int32_t lit) {
+        int v = (int)abs((int64_t)lit);
+        return (uint32_t)(dense.empty() ? v - 1 : dense[v]);
+    };
+
+    UnionFind sets(n_vars);
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        const int32_t* p = formula.begin(c);
+        if(p == formula.end(c)) continue;
+        uint32_t first = var_of(*p);
+        for(p++; p != formula.end(c); p++) sets.unite(first, var_of(*p));
+    }
+
+    FormulaComponents parts;
+    parts.of_clause.resize(formula.size());
+    vector<uint32_t> id(n_vars, NONE);
+    vector<char> counted(n_vars, 0);
+    for(size_t c = 0; c < formula.size(); c++)
+    {
+        uint32_t k;
+        if(formula.length(c) == 0)
+        {
+            k = (uint32_t)parts.count();
+            parts.vars.push_back(0);
+            parts.clauses.push_back(0);
+        }
+        else
+        {
+            uint32_t root = sets.find(var_of(*formula.begin(c)));
+            if(id[root] == NONE)
+            {
+                id[root] = (uint32_t)parts.count();
+                parts.vars.push_back(0);
+                parts.clauses.push_back(0);
+            }
+            k = id[root];
+        }
+        parts.of_clause[c] = k;
+        parts.clauses[k]++;
+        for(const int32_t* p = formula.begin(c); p != formula.end(c); p++)
+        {
+            uint32_t v = var_of(*p);
+            if(!counted[v])
+            {
+                counted[v] = 1;
+                parts.vars[k]++;
+            }
+        }
+    }
+    return parts;
+}
+
+/**
+ * @brief Copies each component of a formula into an arena of its own
+ *
+ * Variables keep their DIMACS numbers, so the solvers renumber the
+ * components densely (see number_variables()).
+ */
+vector<ClauseArena> split_components(const ArenaView& formula, const FormulaComponents& parts)
+{
+    vector<ClauseArena> arenas(parts.count());
+    for(size_t k = 0; k < arenas.size(); k++)
+    {
+        arenas[k].clause_no = (int)parts.clauses[k];
+        arenas[k].offsets.reserve(parts.clauses[k] + 1);
+    }
+    for(size_t c = 0; c < formula.size(); c++) arenas[parts.of_clause[c]].add_clause(formula.begin(c), formula.end(c));
+    return arenas;
+}
+
+/**
+ * @brief Summarizes sizes as counts per power-of-two bucket
+ * @return string For example "1:120 2-3:40 16-31:1"
+ */
+string size_histogram(const vector<size_t>& sizes)
+{
+    map<int, size_t> buckets;   // bucket b holds sizes in [2^(b-1), 2^b), bucket 0 size 0
+    for(size_t n : sizes)
+    {
+        int b = 0;
+        while(b < 64 && (n >> b) != 0) b++;
+        buckets[b]++;
+    }
+
+    ostringstream s;
+    for(auto& kv : buckets)
+    {
+        if(s.tellp() > 0) s << " ";
+        if(kv.first <= 1) s << kv.first;
+        else s << (1ull << (kv.first - 1)) << "-" << (1ull << kv.first) - 1;
+        s << ":" << kv.second;
+    }
+    return s.str();
+}
+
+/**
+ * @brief Decides whether a loaded formula is satisfiable, component by component
+ *
+ * The formula is split into its connected components (see
+ * find_components()), and each is decided by solve_formula() on its own,
+ * largest first, across @p threads. The formula is unsatisfiable as soon as
+ * one component is, which also stops components not yet started, and
+ * satisfiable when all are. The verdict, the procedures used, the Horn
+ * class, the summed search statistics and the component sizes are stored
+ * in @p r.
+ */
+void decide_satisfiability(const ArenaView& formula, unsigned threads, const AnalysisOptions& options, Budget& budget, CnfAnalysis& r)
+{
+    FormulaComponents parts = find_components(formula);
+    r.components = parts.count();
+    r.component_sizes = size_histogram(parts.vars);
+
+    // Satisfiable formulas outside the linear-time classes usually fall to
+    // a short local search; the whole formula is probed at once
+    size_t max_length = 0;
+    for(size_t c = 0; c < formula.size(); c++) max_length = max(max_length, formula.length(c));
+    if(options.probe_time_s > 0 && max_length > 2 && !is_horn(formula))
+    {
+        auto start = chrono::steady_clock::now();
+        SatResult probe = probe_probsat(formula, threads, options.probe_time_s, &budget, r.solver);
+        r.solver.time_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if(probe == SatResult::Sat)
+        {
+            r.sat = "SAT";
+            r.sat_method = "ProbSAT";
+            return;
+        }
+    }
+
+    vector<SatVerdict> verdicts;
+    if(parts.count() <= 1)
+    {
+        verdicts.push_back(solve_formula(formula, options, budget));
+    }
+    else
+    {
+        vector<ClauseArena> arenas = split_components(formula, parts);
+        vector<size_t> order(arenas.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return arenas[a].lits.size() > arenas[b].lits.size(); });
+
+        verdicts.resize(arenas.size());
+        atomic<bool> refuted(false);
+        parallel_for(order.size(), threads, [&](size_t k) {
+            if(refuted.load(memory_order_relaxed)) return;
+            SatVerdict& v = verdicts[order[k]];
+            v = solve_formula(arenas[order[k]], options, budget);
+            if(v.result == SatResult::Unsat) refuted = true;
+        });
+    }
+
+    // Merge: any UNSAT component decides; otherwise all must be SAT
+    SatResult result = SatResult::Sat;
+    bool not_horn = false, unclassified = false, all_horn = true;
+    for(const char* method : {"Horn", "renamable Horn", "2-SAT", "CDCL"})
+    {
+        bool used = any_of(verdicts.begin(), verdicts.end(), [&](const SatVerdict& v) { return v.method == method; });
+        if(used) r.sat_method += (r.sat_method.empty() ? "" : "+") + string(method);
+    }
+    for(const SatVerdict& v : verdicts)
+    {
+        if(v.result == SatResult::Unsat) result = SatResult::Unsat;
+        else if(v.result == SatResult::Unknown && result != SatResult::Unsat) result = SatResult::Unknown;
+
+        not_horn |= (v.horn_class == "not Horn");
+        unclassified |= v.horn_class.empty();
+        all_horn &= (v.horn_class == "Horn");
+
+        r.solver.decisions += v.stats.decisions;
+        r.solver.conflicts += v.stats.conflicts;
+        r.solver.propagations += v.stats.propagations;
+        r.solver.restarts += v.stats.restarts;
+        r.solver.learned += v.stats.learned;
+        r.solver.deleted += v.stats.deleted;
+        r.solver.time_ms += v.stats.time_ms;
+    }
+    r.horn_class = not_horn ? "not Horn" : unclassified ? "" : all_horn ? "Horn" : "renamable Horn";
+    r.sat = result == SatResult::Sat ? "SAT" : result == SatResult::Unsat ? "UNSAT" : "UNKNOWN";
+}
+
+/**
+ * @brief Runs the requested analyses on a formula held in memory
+ *
+ * Besides the clause counts this fills in the clause-shape statistics,
+ * which cost one more scan once the clauses are loaded.
+ */
+void analyze_formula(const ArenaView& formula, unsigned threads, const AnalysisOptions& options, Budget& budget, CnfAnalysis& r)
+{
+    r.n1 = cnf_validcno_arena(formula, threads, &budget);
+    r.shape = cnf_stats(formula);
+    if(options.solve && budget.outcome().empty()) decide_satisfiability(formula, threads, options, budget, r);
+}
+
+/**
+ * @brief Derives the invalid clause count and the verdict once the analyses are done
+ *
+ * A file stopped by a limit gets the limit as its status and no counts.
+ */
+void finish_counts(CnfAnalysis& r, Budget& budget, bool header_ok, int clause_no)
+{
+    r.status = budget.outcome();
+    if(!r.status.empty())
+    {
+        r.n1 = r.n2 = -1;
+    }
+    else if(r.n1 >= 0 && header_ok)
+    {
+        r.ans = (r.n1 == clause_no);
+        r.n2 = clause_no - r.n1;
+    }
+    else
+    {
+        r.n2 = -1;
+    }
+}
+
+/**
+ * @brief Runs all validity checks on one CNF file and times them
+ *
+ * The file is parsed once: the number of invalid clauses and the verdict
+ * follow from the valid clause count and the clause count in the header.
+ * When the file has a fresh binary sidecar (see convert_to_sidecar()) the
+ * sidecar is mapped and scanned instead, without parsing. When
+ * satisfiability is to be decided as well, the file is loaded into a
+ * ClauseArena and both analyses run over it.
+ *
+ * @param path Path to the CNF file in DIMACS format
+ * @param threads Threads to split the file across (see cnf_validcno_split())
+ * @param options Time and memory limits, sidecar use and whether to solve;
+ *                an analysis that exceeds a limit is stopped and reported
+ *                with status TIMEOUT or MEMOUT
+ * @return CnfAnalysis The counts, verdict, time and memory for the file
+ *
+ * @note Safe to call from several threads at once. With threads == 1 the CPU
+ *       and heap figures belong to the calling thread only; when the file is
+ *       split across threads they cover the whole process.
+ */
+CnfAnalysis analyze_file(const string& path, unsigned threads = 1, const AnalysisOptions& options = AnalysisOptions())
+{
+    CnfAnalysis r;
+    r.path = path;
+
+    ResourceMeter meter(threads > 1);
+    Budget budget(options.limits, threads > 1);
+    auto start = chrono::high_resolution_clock::now();
+
+    MappedArena mapped;
+    int clause_no = 0;
+    bool header_ok = false;
+    if(options.use_sidecar && open_fresh_sidecar(path, mapped))
+    {
+        analyze_formula(mapped.view(), threads, options, budget, r);
+        clause_no = mapped.header().clause_no;
+        header_ok = true;
+    }
+    else if(options.solve)
+    {
+        DimacsReader reader(path);
+        header_ok = reader.is_open() && reader.read_header();
+        clause_no = reader.clause_no;
+        ClauseArena arena;
+        if(header_ok && load_arena(reader, arena, plain_file_size(path), &budget)) analyze_formula(arena, threads, options, budget, r);
+        else r.n1 = -1;
+    }
+    else
+    {
+        r.n1 = cnf_validcno_split(path, threads, &budget, header_ok, clause_no);
+    }
+    finish_counts(r, budget, header_ok, clause_no);
+
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double, milli> elapsed_ms = end - start;
+    r.time_ms = elapsed_ms.count();
+    r.usage = meter.stop();
+    return r;
+}
+
+/**
+ * @brief Analyzes every CNF member of a tar archive in one pass
+ *
+ * Members whose name contains ".cnf" are streamed straight from the archive
+ * (decompressed if they are .xz, .gz or .bz2 themselves) into the same
+ * checks as analyze_file(); other members are skipped.
+ *
+ * @param path Path to a .tar, .tar.xz, .tar.gz or .tar.bz2 archive
+ * @param options Time and memory limits and whether to solve, for each member
+ * @return vector<CnfAnalysis> One result per CNF member, in archive order
+ */
+vector<CnfAnalysis> analyze_archive(const string& path, const AnalysisOptions& options = AnalysisOptions())
+{
+    vector<CnfAnalysis> results;
+    TarReader tar(path);
+    if(!tar.is_open())
+    {
+        cout<<"File is not opened"<<endl;
+        return results;
+    }
+
+    while(tar.next_member())
+    {
+        if(tar.name.find(".cnf") == string::npos) continue;
+
+        CnfAnalysis r;
+        r.path = path;
+        r.member = tar.name;
+
+        ResourceMeter meter(false);
+        Budget budget(options.limits, false);
+        auto start = chrono::high_resolution_clock::now();
+
+        bool header_ok;
+        int clause_no;
+        {
+            // Scoped so a decompressing member reader charges its thread before the meter stops
+            DimacsReader reader(tar.open_member());
+            header_ok = reader.is_open() && reader.read_header();
+            clause_no = reader.clause_no;
+            if(!header_ok)
+            {
+                r.n1 = -1;
+            }
+            else if(options.solve)
+            {
+                ClauseArena arena;
+                if(load_arena(reader, arena, tar.size, &budget)) analyze_formula(arena, 1, options, budget, r);
+            }
+            else
+            {
+                r.n1 = count_valid_clauses(reader, reader.var_no, &budget);
+            }
+        }
+        finish_counts(r, budget, header_ok, clause_no);
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double, milli> elapsed_ms = end - start;
+        r.time_ms = elapsed_ms.count();
+        r.usage = meter.stop();
+        results.push_back(r);
+    }
+    return results;
+}
+
+/// Files smaller than this are grouped with others into one task.
+const uintmax_t SMALL_FILE_BYTES = 1 << 20;
+
+/// Target total size of one batch of small files.
+const uintmax_t SMALL_BATCH_BYTES = 8 << 20;
+
+/**
+ * @struct CorpusTask
+ * @brief A unit of work for the pool: one large file or a batch of small ones
+ */
+struct CorpusTask
+{
+    vector<size_t> files;   ///< Indices into the list of corpus files
+    uintmax_t bytes = 0;    ///< Total size of those files
+};
+
+/**
+ * @brief Orders corpus files longest-processing-time first
+ *
+ * Analysis time grows with file size, so tasks are sorted by byte size,
+ * largest first. Handed to parallel_for(), whose workers always claim the
+ * next task in order, this is the LPT rule: the big files start immediately
+ * and the small tasks fill in the gaps at the end, which keeps the makespan
+ * close to the optimum. Files below SMALL_FILE_BYTES are packed into batches
+ * of about SMALL_BATCH_BYTES so that thousands of tiny files do not each pay
+ * the per-task overhead.
+ *
+ * @param sizes Byte size of every file
+ * @return vector<CorpusTask> Tasks in the order they should be started
+ */
+vector<CorpusTask> schedule_lpt(const vector<uintmax_t>& sizes)
+{
+    vector<size_t> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    vector<CorpusTask> tasks;
+    CorpusTask batch;
+    for (size_t i : order) {
+        if (sizes[i] >= SMALL_FILE_BYTES) {
+            CorpusTask task;
+            task.files.push_back(i);
+            task.bytes = sizes[i];
+            tasks.push_back(task);
+            continue;
+        }
+        batch.files.push_back(i);
+        batch.bytes += sizes[i];
+        if (batch.bytes >= SMALL_BATCH_BYTES) {
+            tasks.push_back(batch);
+            batch = CorpusTask();
+        }
+    }
+    if (!batch.files.empty()) tasks.push_back(batch);
+
+    stable_sort(tasks.begin(), tasks.end(), [](const CorpusTask& a, const CorpusTask& b) { return a.bytes > b.bytes; });
+    return tasks;
+}
+
+/**
+ * @struct BenchOptions
+ * @brief Settings of the benchmark mode
+ */
+struct BenchOptions
+{
+    int runs = 0;              ///< Timed runs per file; 0 disables benchmark mode
+    int warmup = 1;            ///< Untimed runs per file before the timed ones
+    bool cold = false;         ///< Evict the file from the page cache before every run
+    string output = "bench.csv"; ///< Result file; written as JSON if it ends in .json
+};
+
+/**
+ * @brief Drops a file's pages from the operating system's page cache
+ *
+ * Uses posix_fadvise(POSIX_FADV_DONTNEED), which evicts clean pages, so the
+ * next read has to come from the disk.
+ *
+ * @return bool False where this is not supported
+ */
+bool drop_file_cache(const string& path)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    int rc = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return rc == 0;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+/**
+ * @brief Quotes a CSV field, doubling embedded quotes
+ */
+string csv_quote(const string& s)
+{
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+/**
+ * @brief Escapes a string for use inside a JSON string literal
+ */
+string json_escape(const string& s)
+{
+    string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (c == '\n') out += "\\n";
+        else if (c == '\t') out += "\\t";
+        else if ((unsigned char)c < 0x20) { char hex[8]; snprintf(hex, sizeof(hex), "\\u%04x", c); out += hex; }
+        else out += c;
+    }
+    return out;
+}
+
+/**
+ * @struct BenchResult
+ * @brief Timing statistics of one file over the benchmark runs
+ */
+struct BenchResult
+{
+    string path;
+    uintmax_t bytes = 0;
+    int runs = 0;
+    double min_ms = 0;
+    double median_ms = 0;
+    double p99_ms = 0;
+    double mb_per_s = 0;   ///< File size divided by the median time
+};
+
+/**
+ * @brief Benchmarks the analysis of every file
+ *
+ * Files are measured one after another, in path order, so runs do not
+ * compete for cores or memory bandwidth. Each file gets `warmup` untimed runs and `runs` timed
+ * ones; in cold mode its pages are evicted before every run. The minimum,
+ * median and 99th percentile (nearest rank) are reported together with the
+ * throughput at the median. The results are written as CSV, or JSON when
+ * the output file name ends in ".json", and include the parser kernel and
+ * compiler so that runs of different builds can be compared.
+ *
+ * @param paths Files to benchmark
+ * @param sizes Their sizes in bytes
+ * @param bench Benchmark settings
+ * @param threads Threads used to split large files (see analyze_file())
+ * @return int 0 on success, -1 if the result file cannot be written
+ */
+int run_benchmark(const vector<string>& paths, const vector<uintmax_t>& sizes, const BenchOptions& bench, unsigned threads)
+{
+    vector<BenchResult> results;
+    bool cold_ok = true;
+
+    vector<size_t> order(paths.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return paths[a] < paths[b]; });
+
+    for (size_t i : order) {
+        auto once = [&]() {
+            if (bench.cold) cold_ok = drop_file_cache(paths[i]) && cold_ok;
+            auto start = chrono::high_resolution_clock::now();
+            if (is_tar_archive(paths[i])) analyze_archive(paths[i]);
+            else analyze_file(paths[i], threads);
+            chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+            return elapsed.count();
+        };
+
+        for (int w = 0; w < bench.warmup; w++) once();
+        vector<double> times;
+        for (int k = 0; k < bench.runs; k++) times.push_back(once());
+        sort(times.begin(), times.end());
+
+        BenchResult r;
+        r.path = paths[i];
+        r.bytes = sizes[i];
+        r.runs = bench.runs;
+        r.min_ms = times.front();
+        r.median_ms = times.size() % 2 ? times[times.size()/2] : (times[times.size()/2 - 1] + times[times.size()/2]) / 2;
+        size_t rank = (size_t)((times.size() * 99 + 99) / 100);  // ceil(0.99 * n)
+        r.p99_ms = times[rank - 1];
+        r.mb_per_s = r.median_ms > 0 ? (r.bytes / 1e6) / (r.median_ms / 1000) : 0;
+        results.push_back(r);
+
+        cout << fs::path(r.path).filename().string() << ": min " << r.min_ms << " ms, median " << r.median_ms
+             << " ms, p99 " << r.p99_ms << " ms, " << r.mb_per_s << " MB/s" << endl;
+    }
+
+    if (bench.cold && !cold_ok) cerr << "Warning: could not evict files from the page cache; runs were warm" << endl;
+
+    ofstream out(bench.output);
+    if (!out) {
+        cerr << "Failed to open benchmark output file!" << endl;
+        return -1;
+    }
+
+    string kernel = (select_literal_parser() == parse_literals_scalar) ? "scalar" : "avx2";
+#if defined(__clang__)
+    string compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    string compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    string compiler = "msvc " + to_string(_MSC_VER);
+#else
+    string compiler = "unknown";
+#endif
+    string cache = bench.cold ? "cold" : "warm";
+
+    bool json = bench.output.size() >= 5 && bench.output.compare(bench.output.size() - 5, 5, ".json") == 0;
+    if (json) {
+        out << "{\n  \"kernel\": \"" << kernel << "\",\n  \"compiler\": \"" << json_escape(compiler) << "\",\n"
+            << "  \"cache\": \"" << cache << "\",\n  \"warmup\": " << bench.warmup << ",\n  \"threads\": " << threads << ",\n"
+            << "  \"files\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            out << "    {\"path\": \"" << json_escape(r.path) << "\", \"bytes\": " << r.bytes << ", \"runs\": " << r.runs
+                << ", \"min_ms\": " << r.min_ms << ", \"median_ms\": " << r.median_ms << ", \"p99_ms\": " << r.p99_ms
+                << ", \"mb_per_s\": " << r.mb_per_s << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    } else {
+        out << "path,bytes,runs,warmup,cache,threads,kernel,compiler,min_ms,median_ms,p99_ms,mb_per_s\n";
+        for (const BenchResult& r : results) {
+            out << csv_quote(r.path) << "," << r.bytes << "," << r.runs << "," << bench.warmup << "," << cache << ","
+                << threads << "," << kernel << "," << csv_quote(compiler) << "," << r.min_ms << "," << r.median_ms << ","
+                << r.p99_ms << "," << r.mb_per_s << "\n";
+        }
+    }
+
+    cout << "Benchmark results written: " << bench.output << endl;
+    return 0;
+}
+
+/**
+ * @brief Formats one analysis result as a single-line JSON object
+ */
+string to_ndjson(const CnfAnalysis& r)
+{
+    ostringstream s;
+    s << "{\"path\": \"" << json_escape(r.path) << "\", \"member\": \"" << json_escape(r.member) << "\""
+      << ", \"result\": \"" << result_text(r) << "\""
+      << ", \"valid_clauses\": " << r.n1 << ", \"invalid_clauses\": " << r.n2
+      << ", \"time_ms\": " << r.time_ms << ", \"user_ms\": " << r.usage.user_ms << ", \"sys_ms\": " << r.usage.sys_ms
+      << ", \"heap_peak_kb\": " << r.usage.heap_peak_kb << ", \"allocated_bytes\": " << r.usage.allocated_bytes
+      << ", \"peak_rss_kb\": " << r.usage.peak_rss_kb << ", \"cached\": " << (r.cached ? "true" : "false")
+      << ", \"fingerprint\": \"" << r.fingerprint << "\", \"duplicate_of\": \"" << json_escape(r.duplicate_of) << "\""
+      << ", \"sat\": \"" << r.sat << "\", \"sat_method\": \"" << r.sat_method << "\", \"horn_class\": \"" << r.horn_class << "\""
+      << ", \"literals\": " << r.shape.literals << ", \"vars_used\": " << r.shape.vars_used << ", \"max_var\": " << r.shape.max_var
+      << ", \"empty_clauses\": " << r.shape.empty << ", \"unit_clauses\": " << r.shape.units << ", \"binary_clauses\": " << r.shape.binary
+      << ", \"ternary_clauses\": " << r.shape.ternary << ", \"max_clause_length\": " << r.shape.max_length
+      << ", \"components\": " << r.components << ", \"component_sizes\": \"" << r.component_sizes << "\", \"decisions\": " << r.solver.decisions << ", \"conflicts\": " << r.solver.conflicts
+      << ", \"propagations\": " << r.solver.propagations << ", \"restarts\": " << r.solver.restarts
+      << ", \"learned\": " << r.solver.learned << ", \"deleted\": " << r.solver.deleted
+      << ", \"flips\": " << r.solver.flips << ", \"solve_ms\": " << r.solver.time_ms << "}";
+    return s.str();
+}
+
+/// Header row of the CSV result file.
+const char* CSV_HEADER = "path,member,result,valid_clauses,invalid_clauses,time_ms,user_ms,sys_ms,"
+                         "heap_peak_kb,allocated_bytes,peak_rss_kb,cached,fingerprint,duplicate_of,"
+                         "literals,vars_used,max_var,empty_clauses,unit_clauses,binary_clauses,ternary_clauses,max_clause_length,"
+                         "sat,sat_method,horn_class,components,component_sizes,decisions,conflicts,propagations,restarts,learned,deleted,flips,solve_ms";
+
+/**
+ * @brief Formats one analysis result as a CSV row matching CSV_HEADER
+ */
+string to_csv(const CnfAnalysis& r)
+{
+    ostringstream s;
+    s << csv_quote(r.path) << "," << csv_quote(r.member) << "," << result_text(r) << ","
+      << r.n1 << "," << r.n2 << "," << r.time_ms << "," << r.usage.user_ms << "," << r.usage.sys_ms << ","
+      << r.usage.heap_peak_kb << "," << r.usage.allocated_bytes << "," << r.usage.peak_rss_kb << ","
+      << (r.cached ? "true" : "false") << "," << r.fingerprint << "," << csv_quote(r.duplicate_of) << ","
+      << r.shape.literals << "," << r.shape.vars_used << "," << r.shape.max_var << "," << r.shape.empty << ","
+      << r.shape.units << "," << r.shape.binary << "," << r.shape.ternary << "," << r.shape.max_length << ","
+      << r.sat << "," << r.sat_method << "," << csv_quote(r.horn_class) << "," << r.components << ","
+      << csv_quote(r.component_sizes) << "," << r.solver.decisions << "," << r.solver.conflicts << "," << r.solver.propagations << ","
+      << r.solver.restarts << "," << r.solver.learned << "," << r.solver.deleted << "," << r.solver.flips << "," << r.solver.time_ms;
+    return s.str();
+}
+
+/**
+ * @brief Splits a one-line JSON object into key/value text
+ *
+ * Understands flat objects whose values are strings, numbers or booleans,
+ * which is all this program writes.
+ *
+ * @return bool False for a malformed (for example truncated) line
+ */
+bool parse_flat_json(const string& line, map<string, string>& fields)
+{
+    size_t i = line.find('{');
+    if (i == string::npos || line.find('}') == string::npos) return false;
+    i++;
+
+    auto skip_ws = [&]() { while (i < line.size() && (line[i] == ' ' || line[i] == ',')) i++; };
+    auto read_string = [&](string& out) {
+        out.clear();
+        if (i >= line.size() || line[i] != '"') return false;
+        for (i++; i < line.size() && line[i] != '"'; i++) {
+            if (line[i] == '\\' && i + 1 < line.size()) {
+                char e = line[++i];
+                if (e == 'n') out += '\n';
+                else if (e == 't') out += '\t';
+                else if (e == 'u' && i + 4 < line.size()) { out += (char)stoi(line.substr(i + 1, 4), nullptr, 16); i += 4; }
+                else out += e;
+            } else {
+                out += line[i];
+            }
+        }
+        if (i >= line.size()) return false;
+        i++;
+        return true;
+    };
+
+    while (true) {
+        skip_ws();
+        if (i >= line.size()) return false;
+        if (line[i] == '}') return true;
+
+        string key, text;
+        if (!read_string(key)) return false;
+        while (i < line.size() && (line[i] == ' ' || line[i] == ':')) i++;
+        if (i < line.size() && line[i] == '"') {
+            if (!read_string(text)) return false;
+        } else {
+            size_t end = line.find_first_of(",}", i);
+            if (end == string::npos) return false;
+            text = line.substr(i, end - i);
+            i = end;
+        }
+        fields[key] = text;
+    }
+}
+
+/**
+ * @brief Parses a line written by to_ndjson() back into a CnfAnalysis
+ *
+ * Unknown keys are ignored.
+ *
+ * @return bool False for a malformed (for example truncated) line
+ * @throws std::invalid_argument, std::out_of_range for a number that does
+ *         not parse
+ */
+bool parse_ndjson(const string& line, CnfAnalysis& r)
+{
+    map<string, string> f;
+    if (!parse_flat_json(line, f) || f.count("path") == 0) return false;
+
+    r.path = f["path"];
+    r.member = f["member"];
+    r.ans = (f["result"] == "Valid");
+    if (f["result"] == "TIMEOUT" || f["result"] == "MEMOUT") r.status = f["result"];
+    r.cached = (f["cached"] == "true");
+    r.fingerprint = f["fingerprint"];
+    r.duplicate_of = f["duplicate_of"];
+    r.sat = f["sat"];
+    r.sat_method = f["sat_method"];
+    r.horn_class = f["horn_class"];
+    r.component_sizes = f["component_sizes"];
+    auto num = [&](const char* key) { return f.count(key) ? f[key] : string("0"); };
+    r.n1 = stoi(num("valid_clauses"));
+    r.n2 = stoi(num("invalid_clauses"));
+    r.time_ms = stod(num("time_ms"));
+    r.usage.user_ms = stod(num("user_ms"));
+    r.usage.sys_ms = stod(num("sys_ms"));
+    r.usage.heap_peak_kb = stoul(num("heap_peak_kb"));
+    r.usage.allocated_bytes = stoull(num("allocated_bytes"));
+    r.usage.peak_rss_kb = stoul(num("peak_rss_kb"));
+    r.shape.literals = stoull(num("literals"));
+    r.shape.vars_used = stoi(num("vars_used"));
+    r.shape.max_var = stoi(num("max_var"));
+    r.shape.empty = stoull(num("empty_clauses"));
+    r.shape.units = stoull(num("unit_clauses"));
+    r.shape.binary = stoull(num("binary_clauses"));
+    r.shape.ternary = stoull(num("ternary_clauses"));
+    r.shape.max_length = stoull(num("max_clause_length"));
+    r.components = stoull(num("components"));
+    r.solver.decisions = stoull(num("decisions"));
+    r.solver.conflicts = stoull(num("conflicts"));
+    r.solver.propagations = stoull(num("propagations"));
+    r.solver.restarts = stoull(num("restarts"));
+    r.solver.learned = stoull(num("learned"));
+    r.solver.deleted = stoull(num("deleted"));
+    r.solver.flips = stoull(num("flips"));
+    r.solver.time_ms = stod(num("solve_ms"));
+    return true;
+}
+
+/**
+ * @class ResultLog
+ * @brief Appends each finished analysis to an NDJSON and a CSV file
+ *
+ * Records are written and flushed as soon as a worker finishes a file, so a
+ * run that dies partway keeps every result it had completed. Either file
+ * can be turned off by passing an empty path. The records are also kept in
+ * memory for the HTML report. Safe to call from several workers at once.
+ */
+class ResultLog
+{
+    public:
+        /**
+         * @brief Creates (truncates) the record files whose path is not empty
+         */
+        ResultLog(const string& ndjson_path, const string& csv_path) :
+            use_ndjson(!ndjson_path.empty()), use_csv(!csv_path.empty())
+        {
+            if (use_ndjson) ndjson.open(ndjson_path);
+            if (use_csv) {
+                csv.open(csv_path);
+                csv << CSV_HEADER << "\n";
+                csv.flush();
+            }
+        }
+
+        bool is_open()
+        {
+            return (!use_ndjson || ndjson.is_open()) && (!use_csv || csv.is_open());
+        }
+
+        /**
+         * @brief Writes and flushes one record to both files
+         */
+        void write(const CnfAnalysis& r)
+        {
+            string j = use_ndjson ? to_ndjson(r) : "";
+            string c = use_csv ? to_csv(r) : "";
+            lock_guard<mutex> lock(m);
+            if (use_ndjson) {
+                ndjson << j << "\n";
+                ndjson.flush();
+            }
+            if (use_csv) {
+                csv << c << "\n";
+                csv.flush();
+            }
+            written.push_back(r);
+        }
+
+        /// Every record written so far.
+        vector<CnfAnalysis> records()
+        {
+            lock_guard<mutex> lock(m);
+            return written;
+        }
+
+        void close()
+        {
+            ndjson.close();
+            csv.close();
+        }
+
+    private:
+        bool use_ndjson;
+        bool use_csv;
+        ofstream ndjson;
+        ofstream csv;
+        mutex m;
+        vector<CnfAnalysis> written;
+};
+
+/**
+ * @brief Loads every complete record of an NDJSON result file
+ *
+ * Malformed lines, such as a last line cut off by a crash, are skipped.
+ */
+vector<CnfAnalysis> read_ndjson(const string& path)
+{
+    vector<CnfAnalysis> records;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        CnfAnalysis r;
+        try {
+            if (parse_ndjson(line, r)) records.push_back(r);
+        } catch (const exception&) {
+            // corrupted line: skip it
+        }
+    }
+    return records;
+}
+
+/**
+ * @brief Fast 64-bit hash of a file's contents
+ *
+ * See hash_bytes(); meant to detect changed files, not for security.
+ *
+ * @return string The hash as 16 hex digits, or "" if the file cannot be read
+ */
+string hash_file(const string& path)
+{
+    ifstream f(path, ios::binary);
+    if (!f) return "";
+    vector<char> block(1 << 20);  // a multiple of 8, so blocks chain like one buffer
+    uint64_t h = HASH_SEED;
+    uint64_t total = 0;
+    while (f.read(block.data(), block.size()) || f.gcount() > 0) {
+        size_t n = (size_t)f.gcount();
+        total += n;
+        h = hash_bytes(h, block.data(), n);
+    }
+    h = hash_finish(h, total);
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return hex;
+}
+
+/**
+ * @class ResultCache
+ * @brief Persistent cache of analysis results, keyed by file path
+ *
+ * An entry is valid while the file's size and modification time are the
+ * ones recorded with it, so unchanged files are served without opening
+ * them. With content hashing enabled a hash of the contents is stored with
+ * new entries, and added to older ones the first time their file is looked
+ * up unchanged. A file whose mtime changed but whose size and hash did not
+ * (for example after the corpus was copied or re-extracted) then still
+ * hits, and its entry is re-stamped with the new mtime. Without content
+ * hashing no file is read a second time.
+ *
+ * The cache file is an append-only NDJSON log: each line is a to_ndjson()
+ * record plus the key fields, and a file's records from a later run
+ * replace the earlier ones. It is compacted when loaded, and new results are
+ * appended and flushed as they arrive, so an interrupted run keeps them.
+ */
+class ResultCache
+{
+    public:
+        /**
+         * @brief Loads and compacts the cache file
+         * @param file Path of the cache file (created if missing); empty
+         *             disables the cache
+         * @param content_hash Compare content hashes when the mtime changed
+         * @param revalidate Ignore cached entries and analyze every file again
+         */
+        ResultCache(const string& file, bool content_hash, bool revalidate) :
+            path(file), use_hash(content_hash), force(revalidate)
+        {
+            run = to_string(chrono::system_clock::now().time_since_epoch().count());
+            if (path.empty()) return;
+            load();
+            compact();
+            log.open(path, ios::app);
+        }
+
+        /**
+         * @brief Looks up the stored results for a file
+         * @param file Path of the file (or archive)
+         * @param records Filled with the cached records, marked as cached
+         * @return bool True on a hit
+         */
+        bool lookup(const string& file, vector<CnfAnalysis>& records)
+        {
+            if (force) return false;
+            auto it = entries.find(file);
+            if (it == entries.end()) return false;
+            Entry& e = it->second;
+
+            error_code ec;
+            uintmax_t size = fs::file_size(file, ec);
+            if (ec || size != e.size) return false;
+            long long mtime = file_mtime(file);
+            if (mtime != e.mtime) {
+                if (!use_hash || e.hash.empty() || hash_file(file) != e.hash) return false;
+                e.mtime = mtime;
+                append(file, e.records, size, mtime, e.hash);
+            } else if (use_hash && e.hash.empty()) {
+                // Hashed lazily: the file is unchanged, so this is the hash of what was analyzed
+                e.hash = hash_file(file);
+                if (!e.hash.empty()) append(file, e.records, size, mtime, e.hash);
+            }
+
+            records = e.records;
+            for (CnfAnalysis& r : records) r.cached = true;
+            return true;
+        }
+
+        /**
+         * @brief Records freshly computed results for a file
+         */
+        void store(const string& file, const vector<CnfAnalysis>& records)
+        {
+            error_code ec;
+            uintmax_t size = fs::file_size(file, ec);
+            if (ec || records.empty() || path.empty()) return;
+            for (const CnfAnalysis& r : records) {
+                if (!r.status.empty()) return;  // a rerun with other limits may finish
+            }
+            append(file, records, size, file_mtime(file), use_hash ? hash_file(file) : "");
+        }
+
+    private:
+        struct Entry
+        {
+            uintmax_t size = 0;
+            long long mtime = 0;
+            string hash;
+            string run;
+            vector<CnfAnalysis> records;
+        };
+
+        string path;
+        bool use_hash;
+        bool force;
+        string run;                               ///< Id of this run, separates reruns of a file
+        unordered_map<string, Entry> entries;
+        ofstream log;
+        mutex m;
+
+        void append(const string& file, const vector<CnfAnalysis>& records, uintmax_t size, long long mtime,
+                    const string& hash)
+        {
+            ostringstream lines;
+            for (const CnfAnalysis& r : records) lines << entry_line(r, file, size, mtime, hash, run) << "\n";
+
+            lock_guard<mutex> lock(m);
+            log << lines.str();
+            log.flush();
+        }
+
+        static string entry_line(const CnfAnalysis& r, const string& file, uintmax_t size, long long mtime,
+                                 const string& hash, const string& run_id)
+        {
+            CnfAnalysis stored = r;
+            stored.cached = false;
+            string line = to_ndjson(stored);
+            line.pop_back();  // reopen the object to add the key fields
+            line += ", \"cache_file\": \"" + json_escape(file) + "\", \"cache_size\": " + to_string(size)
+                  + ", \"cache_mtime\": " + to_string(mtime) + ", \"cache_hash\": \"" + hash + "\""
+                  + ", \"cache_run\": \"" + run_id + "\"}";
+            return line;
+        }
+
+        void load()
+        {
+            ifstream in(path);
+            string line;
+            while (getline(in, line)) {
+                map<string, string> f;
+                CnfAnalysis r;
+                uintmax_t size;
+                long long mtime;
+                try {
+                    if (!parse_flat_json(line, f) || !parse_ndjson(line, r) || f.count("cache_file") == 0) continue;
+                    size = stoull(f["cache_size"]);
+                    mtime = stoll(f["cache_mtime"]);
+                } catch (const exception&) {
+                    continue;  // corrupted line: skip it, the file is analyzed again
+                }
+
+                Entry& e = entries[f["cache_file"]];
+                if (e.run != f["cache_run"] || e.size != size || e.mtime != mtime) {
+                    e = Entry();
+                    e.size = size;
+                    e.mtime = mtime;
+                    e.run = f["cache_run"];
+                }
+                e.hash = f["cache_hash"];
+                e.records.push_back(r);
+            }
+        }
+
+        /// Rewrites the file with only the latest records of each entry.
+        void compact()
+        {
+            string tmp = path + ".tmp";
+            {
+                ofstream out(tmp);
+                if (!out) return;
+                for (auto& kv : entries) {
+                    for (const CnfAnalysis& r : kv.second.records) {
+                        out << entry_line(r, kv.first, kv.second.size, kv.second.mtime, kv.second.hash, kv.second.run) << "\n";
+                    }
+                }
+            }
+            error_code ec;
+            fs::rename(tmp, path, ec);
+        }
+};
+
+/**
+ * @struct RunSummary
+ * @brief Totals of one analysis run, shown below the HTML table
+ */
+struct RunSummary
+{
+    unsigned threads = 1;
+    double wall_ms = 0;
+    double cpu_ms = 0;
+    double utilization = 0;
+};
+
+/**
+ * @brief Renders analysis records as the HTML report
+ *
+ * Rows are sorted by path and member, so the report does not depend on the
+ * order in which the records were written.
+ *
+ * @param records Results, typically loaded with read_ndjson()
+ * @param output_file Path of the HTML file to write
+ * @param summary Run totals to show, or nullptr to leave them out
+ * @return bool False if the output file cannot be opened
+ */
+bool write_html_report(vector<CnfAnalysis> records, const string& output_file, const RunSummary* summary)
+{
+    ofstream out(output_file);
+    if (!out) return false;
+
+    sort(records.begin(), records.end(), [](const CnfAnalysis& a, const CnfAnalysis& b) {
+        return a.path != b.path ? a.path < b.path : a.member < b.member;
+    });
+
+    // --- HTML header ---
+    out << "<!DOCTYPE html>\n<html>\n<head>\n<title>CNF Analysis and Results</title>\n"
+        << "<style>\n"
+        << "table { border-collapse: collapse; width: 100%; }\n"
+        << "th, td { border: 1px solid black; padding: 8px; text-align: left; }\n"
+        << "th { background-color: #f2f2f2; }\n"
+        << "tr.invalid { background-color: #fdd; }\n"
+        << "tr.valid { background-color: #dfd; }\n"
+        << "tr.limit { background-color: #ddd; }\n"
+        << "</style>\n</head>\n<body>\n";
+
+    // Satisfiability columns only when some file was solved
+    bool solved = any_of(records.begin(), records.end(), [](const CnfAnalysis& r) { return !r.sat.empty(); });
+    // Clause-shape columns only when some formula was loaded
+    bool shaped = any_of(records.begin(), records.end(), [](const CnfAnalysis& r) { return r.shape.literals > 0 || r.shape.empty > 0; });
+    auto per_second = [](uint64_t count, double ms) { return ms > 0 ? (uint64_t)(count * 1000.0 / ms) : 0; };
+
+    out << "<h1>CNF Files Analysis and Results</h1>\n";
+    out << "<table>\n";
+    out << "<tr><th>File</th><th>Result</th><th>Valid Clauses</th>"
+           "<th>Invalid Clauses</th><th>Time (ms)</th><th>User CPU (ms)</th><th>System CPU (ms)</th>"
+           "<th>Heap Peak (KB)</th><th>Allocated (KB)</th><th>Peak RSS (KB)</th>";
+    if (shaped) out << "<th>Variables Used</th><th>Literals</th><th>Unit/Binary/Ternary Clauses</th><th>Longest Clause</th>";
+    if (solved) out << "<th>Satisfiability</th><th>Components</th><th>Decisions/s</th><th>Conflicts/s</th><th>Propagations/s</th>";
+    out << "</tr>\n";
+
+    for (const CnfAnalysis& r : records) {
+        // --- Table row with color based on validity ---
+
+        string filename = fs::path(r.path).filename().string();
+        if (!r.member.empty()) filename += ":" + r.member;
+        if (!r.duplicate_of.empty()) filename += " (duplicate of " + fs::path(r.duplicate_of).filename().string() + ")";
+        out << "<tr class='" << (!r.status.empty() ? "limit" : r.ans ? "valid" : "invalid") << "'>";
+        out << "<td>" << filename << "</td>";
+        out << "<td>" << result_text(r) << "</td>";
+        out << "<td>" << r.n1 << "</td>";
+        out << "<td>" << r.n2 << "</td>";
+        out << "<td>" << r.time_ms << (r.cached ? " (cached)" : "") << "</td>";
+        out << "<td>" << r.usage.user_ms << "</td>";
+        out << "<td>" << r.usage.sys_ms << "</td>";
+        out << "<td>" << r.usage.heap_peak_kb << "</td>";
+        out << "<td>" << r.usage.allocated_bytes / 1024 << "</td>";
+        out << "<td>" << r.usage.peak_rss_kb << "</td>";
+        if (shaped) {
+            out << "<td title='largest variable " << r.shape.max_var << "'>" << r.shape.vars_used << "</td>";
+            out << "<td>" << r.shape.literals << "</td>";
+            out << "<td title='empty clauses " << r.shape.empty << "'>" << r.shape.units << " / " << r.shape.binary << " / " << r.shape.ternary << "</td>";
+            out << "<td>" << r.shape.max_length << "</td>";
+        }
+        if (solved) {
+            out << "<td>" << r.sat << (r.sat_method.empty() ? "" : " (" + r.sat_method + ")") << "</td>";
+            out << "<td title='variables:components " << r.component_sizes << "'>" << r.components << "</td>";
+            out << "<td>" << per_second(r.solver.decisions, r.solver.time_ms) << "</td>";
+            out << "<td>" << per_second(r.solver.conflicts, r.solver.time_ms) << "</td>";
+            out << "<td>" << per_second(r.solver.propagations, r.solver.time_ms) << "</td>";
+        }
+        out << "</tr>\n";
+    }
+    out << "</table>\n";
+
+    // --- Run summary ---
+    if (summary) {
+        out << "<p>Files: " << records.size() << " | Threads: " << summary->threads
+            << " | Wall time: " << summary->wall_ms << " ms"
+            << " | CPU time: " << summary->cpu_ms << " ms"
+            << " | CPU utilization: " << summary->utilization << "%</p>\n";
+    }
+
+    // --- Close HTML ---
+    out << "</body>\n</html>\n";
+    return true;
+}
+
+/**
+ * @brief Writes the binary sidecar of every DIMACS file, in parallel
+ *
+ * Tar archives and existing sidecars among the inputs are skipped.
+ *
+ * @return int 0 if every sidecar was written, -1 otherwise
+ */
+int convert_files(const vector<string>& paths, unsigned threads)
+{
+    atomic<size_t> written(0), failed(0);
+    mutex out;
+    parallel_for(paths.size(), threads, [&](size_t i) {
+        const string& path = paths[i];
+        if (is_tar_archive(path) || is_sidecar(path)) return;
+        if (convert_to_sidecar(path)) {
+            written++;
+        } else {
+            failed++;
+            lock_guard<mutex> lock(out);
+            cerr << "Failed to convert " << path << endl;
+        }
+    });
+    cout << "Sidecars written: " << written << ", failed: " << failed << endl;
+    return failed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Reads candidate assignments in the SAT competition output format
+ *
+ * Each assignment is a list of literals ended by 0, on one or more lines;
+ * lines may start with "v" as solvers print them, and "c" and "s" lines are
+ * skipped. A last assignment without its closing 0 is kept.
+ *
+ * @return bool False if the file cannot be opened or holds something other
+ *         than literals
+ */
+bool read_assignments(const string& filepath, vector<vector<int32_t>>& assignments)
+{
+    ifstream in(filepath);
+    if (!in) return false;
+
+    vector<int32_t> current;
+    string line, token;
+    while (getline(in, line)) {
+        istringstream words(line);
+        if (!(words >> token) || token == "c" || token == "s") continue;
+        if (token != "v") words.seekg(0);
+        while (words >> token) {
+            char* end;
+            long lit = strtol(token.c_str(), &end, 10);
+            if (*end != '\0' || lit < -INT32_MAX || lit > INT32_MAX) return false;
+            if (lit != 0) {
+                current.push_back((int32_t)lit);
+            } else {
+                assignments.push_back(current);
+                current.clear();
+            }
+        }
+    }
+    if (!current.empty()) assignments.push_back(current);
+    return true;
+}
+
+/**
+ * @brief Checks every assignment in a file against a formula and prints the outcome
+ *
+ * Prints each assignment that violates a clause with the first such clause,
+ * then the totals (see verify_assignments()).
+ *
+ * @return int 0 if every assignment satisfies the formula, -1 otherwise
  */
-int cnf_validcno(string filepath)
+int verify_models(const string& formula_path, const string& models_path, unsigned threads)
 {
-    int valid_clause_no = 0;
-    ifstream f(filepath);
-
-    if(!f.is_open())
-    {
-        cout<<"File is not opened"<<endl;
+    MappedArena mapped;
+    ClauseArena arena;
+    ArenaView formula;
+    if (!open_formula(formula_path, mapped, arena, formula)) {
+        cerr << "Failed to read " << formula_path << endl;
         return -1;
     }
 
-    string line;
-    string token;
-    
-    // Skip lines until we find the problem line (starts with 'p')
-    while(getline(f,line))
-    {
-        if(line[0] == 'p') break;
+    vector<vector<int32_t>> assignments;
+    if (!read_assignments(models_path, assignments)) {
+        cerr << "Failed to read assignments from " << models_path << endl;
+        return -1;
     }
-    
-    // Parse the problem line: p cnf <variables> <clauses>
-    stringstream ss(line);
-    getline(ss,token,' ');  // 'p'
-    getline(ss,token,' ');  // 'cnf'
-    getline(ss,token,' ');  // number of variables
-    int var_no = stoi(token);
-    getline(ss,token,' ');  // number of clauses
-    int clause_no = stoi(token);
-    int no;
 
-    unordered_set<int> uset;
-    
-    // Process each clause
-    for(int i = 0; i<clause_no; i++)
-    {
-        uset.clear();
+    auto start = chrono::high_resolution_clock::now();
+    vector<int64_t> violated = verify_assignments(formula, assignments, threads);
+    chrono::duration<double, milli> elapsed_ms = chrono::high_resolution_clock::now() - start;
 
-        getline(f,line);
-        stringstream ss(line);
-        
-        // Read each literal in the clause
-        while(getline(ss,token,' '))
-        {
-            no = stoi(token);
-            if(no==0)  // 0 marks end of clause
-            {
-                continue;
-            }
-            else
-            {
-                // Check if negation of current literal already exists
-                if(uset.find(no*(-1))!=uset.end())
-                {
-                    valid_clause_no++;
-                    break;  // Found a tautology, move to next clause
-                }
-                else
-                {
-                    uset.insert(no);
-                }
-            }
+    size_t satisfying = 0, contradictory = 0;
+    for (size_t i = 0; i < violated.size(); i++) {
+        if (violated[i] == VERIFY_CONTRADICTORY) {
+            vector<int32_t> lits = assignments[i];
+            sort(lits.begin(), lits.end(), [](int32_t a, int32_t b) { return abs(a) < abs(b) || (abs(a) == abs(b) && a < b); });
+            size_t k = 1;
+            while (k < lits.size() && lits[k] != -lits[k - 1]) k++;
+            cout << "Assignment " << i + 1 << " is not an assignment: it sets variable " << abs(lits[k]) << " both true and false" << endl;
+            contradictory++;
+            continue;
         }
+        if (violated[i] < 0) {
+            satisfying++;
+            continue;
+        }
+        cout << "Assignment " << i + 1 << " violates clause " << violated[i] + 1 << ":";
+        for (const int32_t* p = formula.begin(violated[i]); p != formula.end(violated[i]); p++) cout << " " << *p;
+        cout << " 0" << endl;
     }
-    f.close();
+    cout << "Assignments: " << assignments.size() << ", satisfying: " << satisfying
+         << ", violating: " << assignments.size() - satisfying - contradictory << ", contradictory: " << contradictory
+         << " (" << elapsed_ms.count() << " ms)" << endl;
+    return satisfying == assignments.size() ? 0 : -1;
+}
 
-    return valid_clause_no;
+/**
+ * @brief Checks a DRAT proof that a formula is unsatisfiable and prints the outcome
+ *
+ * The proof is streamed into a DratChecker until it refutes the formula,
+ * then checked backwards. Prints "s VERIFIED" or "s NOT VERIFIED", the step
+ * counts, the core sizes and the time of both passes.
+ *
+ * @param limits Time and memory limits for the whole check
+ * @return int 0 if the proof is verified, -1 otherwise
+ */
+int check_proof(const string& formula_path, const string& proof_path, const Limits& limits)
+{
+    MappedArena mapped;
+    ClauseArena arena;
+    ArenaView formula;
+    if (!open_formula(formula_path, mapped, arena, formula)) {
+        cerr << "Failed to read " << formula_path << endl;
+        return -1;
+    }
+    DratReader proof(proof_path);
+    if (!proof.is_open()) {
+        cerr << "Failed to read " << proof_path << endl;
+        return -1;
+    }
+
+    Budget budget(limits, false);
+    auto start = chrono::high_resolution_clock::now();
+    DratChecker checker(formula);
+    vector<int32_t> step;
+    bool deletion;
+    size_t steps = 0;
+    while (!checker.refuted() && proof.next(step, deletion)) {
+        checker.add_step(step, deletion);
+        if ((++steps & 0xFFF) == 0 && budget.exceeded()) break;
+    }
+    if (proof.failed()) {
+        cerr << "Malformed proof at byte " << proof.bytes_read() << " of " << proof_path << endl;
+        return -1;
+    }
+    auto forward_end = chrono::high_resolution_clock::now();
+    bool verified = budget.outcome().empty() && checker.verify(&budget);
+    auto end = chrono::high_resolution_clock::now();
+
+    chrono::duration<double, milli> forward_ms = forward_end - start, backward_ms = end - forward_end;
+    cout << (verified ? "s VERIFIED" : "s NOT VERIFIED") << endl;
+    if (!verified) cout << "Reason: " << (budget.outcome().empty() ? checker.message : budget.outcome()) << endl;
+    cout << "Proof: " << checker.lemmas << " lemmas, " << checker.deletions << " deletions ("
+         << checker.ignored_deletions << " ignored), " << proof.bytes_read() << " bytes read" << endl;
+    cout << "Core: " << checker.core_clauses << " of " << formula.size() << " clauses, "
+         << checker.core_lemmas << " of " << checker.lemmas << " lemmas" << endl;
+    cout << "Time: " << forward_ms.count() << " ms forward (parsing and propagation), "
+         << backward_ms.count() << " ms backward" << endl;
+    return verified ? 0 : -1;
 }
 
 /**
- * @brief Counts the number of non-valid (non-tautology) clauses in a CNF formula
- * 
- * Calculates the difference between total clauses and valid clauses.
- * 
- * @param filepath Path to the CNF file in DIMACS format
- * @return int Number of non-valid clauses, or -1 if file cannot be opened
- * 
- * @see cnf_validcno()
+ * @struct SimplifyOptions
+ * @brief Stages of the simplify command beyond unit propagation and pure literals
  */
-int cnf_non_valid_cno(string filepath)
+struct SimplifyOptions
 {
-    ifstream f(filepath);
+    bool substitute = false;   ///< Replace equivalent literals (see substitute_equivalences())
+    bool eliminate = false;    ///< Run an Eliminator
+};
 
-    if(!f.is_open())
-    {
-        cout<<"File is not opened"<<endl;
+/**
+ * @brief Simplifies a formula and writes the result
+ *
+ * Runs propagate_units_and_pures(), then the stages chosen in @p options,
+ * writes the clauses left to @p output_path (see write_formula()) and
+ * prints what was removed. With substitution, the variables replaced are
+ * written to @p output_path + ".map", one "VAR LIT" line each. With
+ * elimination, the reconstruction stack (see Eliminator::extract()) is
+ * written as DIMACS to @p output_path + ".stack"; it starts with the fixed
+ * literals as unit entries and the equivalences as pairs of binary
+ * entries, so it alone turns a model of the output into one of the input.
+ *
+ * @param limits Time and memory limits; when one is hit, the
+ *               simplifications made so far are written
+ * @return int 0 if the result was written, -1 otherwise
+ */
+int simplify_file(const string& formula_path, const string& output_path, const Limits& limits,
+                  const SimplifyOptions& options)
+{
+    MappedArena mapped;
+    ClauseArena arena;
+    ArenaView formula;
+    if (!open_formula(formula_path, mapped, arena, formula)) {
+        cerr << "Failed to read " << formula_path << endl;
         return -1;
     }
 
-    string line;
-    string token;
-    
-    // Skip to problem line
-    while(getline(f,line))
-    {
-        if(line[0] == 'p') break;
+    Budget budget(limits, false);
+    auto start = chrono::high_resolution_clock::now();
+    ClauseArena simplified, stack;
+    vector<int32_t> fixed;
+    SimplifyStats stats;
+    SatResult result = propagate_units_and_pures(formula, simplified, fixed, stats, &budget);
+    stack.var_no = formula.var_no;
+    for (int32_t lit : fixed) stack.add_clause(&lit, &lit + 1);
+
+    if (options.substitute) {
+        vector<pair<int32_t, int32_t>> mapping;
+        if (result == SatResult::Unknown) {
+            ClauseArena substituted;
+            result = substitute_equivalences(simplified, substituted, mapping, stats, &budget);
+            simplified = move(substituted);
+        }
+        ofstream map_file(output_path + ".map");
+        for (auto& m : mapping) {
+            map_file << m.first << " " << m.second << "\n";
+            int32_t entries[2][2] = {{m.first, -m.second}, {-m.first, m.second}};
+            for (auto& entry : entries) stack.add_clause(entry, entry + 2);
+        }
+        if (!map_file) {
+            cerr << "Failed to write " << output_path << ".map" << endl;
+            return -1;
+        }
     }
-    
-    // Parse problem line
-    stringstream ss(line);
-    getline(ss,token,' ');
-    getline(ss,token,' ');
-    getline(ss,token,' ');
-    int var_no = stoi(token);
-    getline(ss,token,' ');
-    int clause_no = stoi(token);
-    int no;
-    
-    return clause_no-cnf_validcno(filepath);
+    if (options.eliminate && result == SatResult::Unknown) {
+        Eliminator eliminator(simplified);
+        result = eliminator.run(stats, &budget);
+        ClauseArena eliminated;
+        eliminator.extract(simplified, eliminated);
+        for (size_t e = 0; e < eliminated.size(); e++) stack.add_clause(eliminated.begin(e), eliminated.end(e));
+    }
+    if (options.eliminate) {
+        stack.clause_no = (int)stack.size();
+        if (!write_dimacs(stack, output_path + ".stack")) {
+            cerr << "Failed to write " << output_path << ".stack" << endl;
+            return -1;
+        }
+    }
+    if (!write_formula(simplified, output_path)) {
+        cerr << "Failed to write " << output_path << endl;
+        return -1;
+    }
+    stats.clauses_after = simplified.size();
+    stats.vars_after = count_occurring_vars(simplified);
+    stats.time_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    if (result != SatResult::Unknown) cout << (result == SatResult::Sat ? "s SATISFIABLE" : "s UNSATISFIABLE") << endl;
+    if (!budget.outcome().empty()) cout << "Stopped early: " << budget.outcome() << endl;
+    cout << "Variables: " << stats.vars_before << " -> " << stats.vars_after
+         << " (" << stats.vars_before - stats.vars_after << " removed; "
+         << stats.units << " fixed by units, " << stats.pures << " pure";
+    if (options.substitute) cout << ", " << stats.substituted << " substituted";
+    if (options.eliminate) cout << ", " << stats.eliminated << " eliminated";
+    cout << ")" << endl;
+    cout << "Clauses: " << stats.clauses_before << " -> " << stats.clauses_after
+         << " (" << stats.clauses_before - stats.clauses_after << " removed";
+    if (options.eliminate) {
+        cout << "; " << stats.subsumed << " subsumed, " << stats.blocked << " blocked, "
+             << stats.strengthened << " literals strengthened away";
+    }
+    cout << ")" << endl;
+    cout << "Time: " << stats.time_ms << " ms" << endl;
+    return 0;
 }
 
+/// How --dedup recognizes copies of the same instance.
+enum class Dedup { None, Exact, Renaming };
+
+/// Largest worker thread count accepted by -j.
+const long long MAX_THREADS = 1024;
+
 /**
- * @brief Checks if all clauses in a CNF formula are valid (tautologies)
- * 
- * A CNF formula is considered "valid" in this context if all of its clauses
- * are tautologies (each contains both a literal and its negation).
- * 
- * @param filepath Path to the CNF file in DIMACS format
- * @return bool True if all clauses are valid (tautologies), false otherwise
- * @return bool Returns false (cast from -1) if file cannot be opened
- * 
- * @note This definition of "valid" is specific to this implementation and
- *       differs from standard SAT terminology
- * 
- * @see cnf_validcno()
+ * @struct CliOptions
+ * @brief Everything that can be set on the command line
  */
-bool cnf_validitychecker(string filepath)
+struct CliOptions
 {
-    ifstream f(filepath);
+    vector<string> inputs;            ///< Files, directories and glob patterns to analyze
+    bool recursive = false;           ///< Descend into subdirectories
+    unsigned threads = 1;             ///< Worker threads
+    string output = "Analysis.html";  ///< HTML report; also the base name of the other outputs
+    string ndjson;                    ///< NDJSON record file; empty means derived from output
+    string csv;                       ///< CSV record file; empty means derived from output
+    bool write_html = true;
+    bool write_ndjson = true;
+    bool write_csv = true;
+    SimplifyOptions simplify;         ///< Stages of the simplify command
+    string command;                   ///< "convert" to write binary sidecars, "verify" to check
+                                      ///< assignments, "drat" to check a proof, "simplify" to
+                                      ///< preprocess a formula; empty to analyze
+    AnalysisOptions analysis;         ///< Limits and sidecar use for every file
+    string cache_file;                ///< Result cache; empty means derived from output
+    bool use_cache = true;
+    bool cache_hash = false;
+    bool revalidate = false;
+    Dedup dedup = Dedup::None;        ///< Analyze each distinct instance only once
+    string html_from;                 ///< Re-render the report from this NDJSON file and exit
+    BenchOptions bench;
+    bool help = false;
+};
 
-    if(!f.is_open())
-    {
-        cout<<"File is not opened"<<endl;
-        return -1;
+/**
+ * @brief Prints the command-line help
+ */
+void print_usage(const char* program)
+{
+    cout << "Usage: " << program << " [options] INPUT...\n"
+         << "       " << program << " convert [-r] INPUT...\n"
+         << "       " << program << " verify [-j N] FORMULA ASSIGNMENTS\n"
+         << "       " << program << " drat [--time-limit SEC] [--mem-limit MB] FORMULA PROOF\n"
+         << "       " << program << " simplify [--substitute] [--eliminate] [--time-limit SEC] [--mem-limit MB] FORMULA OUTPUT\n"
+         << "\n"
+         << "INPUT is a CNF file (.cnf, .cnf.xz/.gz/.bz2, or a tar archive), a directory,\n"
+         << "or a glob pattern such as 'corpus/*.cnf' or 'corpus/**/*.cnf.xz'.\n"
+         << "\n"
+         << "convert writes a binary sidecar (INPUT" << SIDECAR_SUFFIX << ") next to each DIMACS file. Later\n"
+         << "runs map a sidecar instead of parsing while it matches the file's size and mtime.\n"
+         << "\n"
+         << "verify checks each assignment in ASSIGNMENTS (solver output, \"v\" lines ended by 0)\n"
+         << "against FORMULA, 256 at a time, and names the first clause each one violates.\n"
+         << "\n"
+         << "drat checks that PROOF, a text or binary DRAT proof (optionally compressed), shows\n"
+         << "FORMULA unsatisfiable, and reports the unsatisfiable core it uses.\n"
+         << "\n"
+         << "simplify propagates unit clauses and removes pure literals, then writes the\n"
+         << "clauses left to OUTPUT: as DIMACS, or in the binary format if OUTPUT ends in " << SIDECAR_SUFFIX << ".\n"
+         << "With --substitute it replaces equivalent literals, found as strongly connected\n"
+         << "components of the binary clauses, and writes the replacements to OUTPUT.map.\n"
+         << "With --eliminate it also removes subsumed and blocked clauses and eliminates\n"
+         << "variables by resolution, and writes OUTPUT.stack: clauses whose first literal is\n"
+         << "set true, from the last clause to the first, where a model of OUTPUT violates them.\n"
+         << "\n"
+         << "Options:\n"
+         << "  -r, --recursive        Walk directories recursively\n"
+         << "  -j, --threads N        Worker threads, 1 to 1024 (default: hardware threads)\n"
+         << "  -o, --output FILE      HTML report (default: Analysis.html)\n"
+         << "      --format LIST      Outputs to write, any of html,ndjson,csv (default: all)\n"
+         << "      --ndjson FILE      NDJSON record file (default: <output>.ndjson)\n"
+         << "      --csv FILE         CSV record file (default: <output>.csv)\n"
+         << "      --time-limit SEC   Stop a file's analysis after SEC seconds (TIMEOUT)\n"
+         << "      --mem-limit MB     Stop a file's analysis above MB megabytes of heap (MEMOUT)\n"
+         << "      --cache-file FILE  Result cache (default: <output>.cache)\n"
+         << "      --cache-hash       Accept cache entries whose mtime changed but content did not\n"
+         << "      --revalidate       Analyze every file again and refresh the cache\n"
+         << "      --no-cache         Do not read or write the result cache\n"
+         << "      --no-sidecar       Parse the DIMACS text even where a fresh sidecar exists\n"
+         << "      --solve            Also decide satisfiability (SAT, UNSAT or UNKNOWN)\n"
+         << "      --solve-time SEC   Give up the search after SEC seconds per file (UNKNOWN)\n"
+         << "      --probe-time SEC   Local search probe before the search (default: 0.1, 0: off)\n"
+         << "      --dedup            Analyze files with the same clauses (in any order) once\n"
+         << "      --dedup-renamed    Also treat copies with renamed variables as duplicates\n"
+         << "                         (matched by occurrence statistics, which can collide)\n"
+         << "      --substitute       simplify: also replace equivalent literals\n"
+         << "      --eliminate        simplify: also eliminate variables and blocked clauses\n"
+         << "      --html-from FILE   Only render the HTML report from an NDJSON file\n"
+         << "      --bench K          Benchmark mode: K timed runs per file\n"
+         << "      --warmup W         Untimed runs per file before the timed ones (default: 1)\n"
+         << "      --cache warm|cold  Page cache state for benchmark runs (default: warm)\n"
+         << "      --bench-out FILE   Benchmark results, CSV or .json (default: bench.csv)\n"
+         << "  -h, --help             Show this help\n";
+}
+
+/**
+ * @brief Parses the command line
+ *
+ * @param argc Argument count from main()
+ * @param argv Argument vector from main()
+ * @param opt Receives the options
+ * @param error Receives a message when parsing fails
+ * @return bool False for an unknown option, a missing value or a bad number
+ */
+bool parse_cli(int argc, char* argv[], CliOptions& opt, string& error)
+{
+    opt.threads = thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto value = [&](string& out) {
+            if (i + 1 >= argc) {
+                error = "missing value for " + arg;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+        string v;
+        // Whole-string numbers within bounds; anything else throws and is reported below
+        auto integer = [&](long long lo, long long hi) {
+            size_t used = 0;
+            long long x = stoll(v, &used);
+            if (used != v.size() || x < lo || x > hi) throw invalid_argument(v);
+            return x;
+        };
+        auto seconds = [&]() {
+            size_t used = 0;
+            double x = stod(v, &used);
+            if (used != v.size() || !isfinite(x) || x < 0) throw invalid_argument(v);
+            return x;
+        };
+
+        try {
+            if (arg == "-h" || arg == "--help") opt.help = true;
+            else if (arg == "-r" || arg == "--recursive") opt.recursive = true;
+            else if (arg == "--cache-hash") opt.cache_hash = true;
+            else if (arg == "--revalidate") opt.revalidate = true;
+            else if (arg == "--no-cache") opt.use_cache = false;
+            else if (arg == "--no-sidecar") opt.analysis.use_sidecar = false;
+            else if (arg == "--solve") opt.analysis.solve = true;
+            else if (arg == "--substitute") opt.simplify.substitute = true;
+            else if (arg == "--eliminate") opt.simplify.eliminate = true;
+            else if (arg == "--dedup") opt.dedup = Dedup::Exact;
+            else if (arg == "--dedup-renamed") opt.dedup = Dedup::Renaming;
+            else if (arg.size() > 1 && arg[0] == '-') {
+                static const vector<string> with_value = {
+                    "-j", "--threads", "-o", "--output", "--ndjson", "--csv", "--format", "--time-limit",
+                    "--mem-limit", "--solve-time", "--probe-time", "--cache-file", "--html-from", "--bench", "--warmup", "--cache", "--bench-out"};
+                if (find(with_value.begin(), with_value.end(), arg) == with_value.end()) {
+                    error = "unknown option: " + arg;
+                    return false;
+                }
+                if (!value(v)) return false;
+                if (arg == "-j" || arg == "--threads") opt.threads = (unsigned)integer(1, MAX_THREADS);
+                else if (arg == "-o" || arg == "--output") opt.output = v;
+                else if (arg == "--ndjson") opt.ndjson = v;
+                else if (arg == "--csv") opt.csv = v;
+                else if (arg == "--time-limit") opt.analysis.limits.time_s = seconds();
+                else if (arg == "--mem-limit") opt.analysis.limits.memory_mb = (size_t)integer(0, (long long)(SIZE_MAX >> 21));
+                else if (arg == "--solve-time") opt.analysis.solve_time_s = seconds();
+                else if (arg == "--probe-time") opt.analysis.probe_time_s = seconds();
+                else if (arg == "--cache-file") opt.cache_file = v;
+                else if (arg == "--html-from") opt.html_from = v;
+                else if (arg == "--bench") opt.bench.runs = (int)integer(1, INT_MAX);
+                else if (arg == "--warmup") opt.bench.warmup = (int)integer(0, INT_MAX);
+                else if (arg == "--bench-out") opt.bench.output = v;
+                else if (arg == "--cache") {
+                    if (v != "warm" && v != "cold") {
+                        error = "--cache must be warm or cold";
+                        return false;
+                    }
+                    opt.bench.cold = (v == "cold");
+                }
+                else if (arg == "--format") {
+                    opt.write_html = opt.write_ndjson = opt.write_csv = false;
+                    stringstream list(v);
+                    string format;
+                    while (getline(list, format, ',')) {
+                        if (format == "html") opt.write_html = true;
+                        else if (format == "ndjson") opt.write_ndjson = true;
+                        else if (format == "csv") opt.write_csv = true;
+                        else {
+                            error = "unknown format: " + format;
+                            return false;
+                        }
+                    }
+                }
+            }
+            else if ((arg == "convert" || arg == "verify" || arg == "drat" || arg == "simplify") && opt.command.empty() && opt.inputs.empty()) opt.command = arg;
+            else opt.inputs.push_back(arg);
+        } catch (const exception&) {
+            error = "invalid value for " + arg + ": " + v;
+            return false;
+        }
     }
 
-    string line;
-    string token;
-    
-    // Skip to problem line
-    while(getline(f,line))
-    {
-        if(line[0] == 'p') break;
+    if (opt.threads == 0) opt.threads = 1;
+    string base = fs::path(opt.output).replace_extension().string();
+    if (opt.ndjson.empty()) opt.ndjson = base + ".ndjson";
+    if (opt.csv.empty()) opt.csv = base + ".csv";
+    if (opt.cache_file.empty()) opt.cache_file = base + ".cache";
+    return true;
+}
+
+/**
+ * @brief Matches a path against a glob pattern
+ *
+ * `?` matches one character, `[abc]` / `[a-z]` / `[!a-z]` one character of
+ * a set, `*` any run of characters within one path component and `**` any
+ * run including '/'. Both paths and patterns use '/' as separator.
+ */
+bool glob_match(const char* pat, const char* s)
+{
+    while (*pat) {
+        if (pat[0] == '*' && pat[1] == '*') {
+            pat += 2;
+            if (*pat == '/') pat++;   // "**/" also matches no directory at all
+            for (const char* t = s; ; t++) {
+                if (glob_match(pat, t)) return true;
+                if (*t == '\0') return false;
+            }
+        }
+        if (*pat == '*') {
+            pat++;
+            for (const char* t = s; ; t++) {
+                if (glob_match(pat, t)) return true;
+                if (*t == '\0' || *t == '/') return false;
+            }
+        }
+        if (*s == '\0') return false;
+        if (*pat == '[') {
+            const char* p = pat + 1;
+            bool negate = (*p == '!' || *p == '^');
+            if (negate) p++;
+            bool found = false;
+            for (bool first = true; *p && (first || *p != ']'); first = false, p++) {
+                if (p[1] == '-' && p[2] && p[2] != ']') {
+                    if (*s >= p[0] && *s <= p[2]) found = true;
+                    p += 2;
+                } else if (*p == *s) {
+                    found = true;
+                }
+            }
+            if (*p != ']' || found == negate || *s == '/') return false;
+            pat = p + 1;
+            s++;
+            continue;
+        }
+        if (*pat != '?' && *pat != *s) return false;
+        if (*pat == '?' && *s == '/') return false;
+        pat++;
+        s++;
     }
-    
-    // Parse problem line
-    stringstream ss(line);
-    getline(ss,token,' ');
-    getline(ss,token,' ');
-    getline(ss,token,' ');
-    getline(ss,token,' ');
-    int clause_no = stoi(token);
-    int valid_clauseno = cnf_validcno(filepath);
-    f.close();
-    
-    if(valid_clauseno == clause_no) return true;
-    else return false;
+    return *s == '\0';
 }
 
 /**
- * @brief Get the current memory usage of the running process.
- * 
- * This function uses the Windows API to retrieve the current working set size
- * of the process (i.e., the amount of memory currently in RAM for the process).
- * It returns the memory usage in kilobytes (KB).
- * 
- * @return size_t The current memory usage of the process in KB. Returns 0 if 
- *                the memory information cannot be retrieved.
- * 
- * @note This measures the memory of the entire process, not a specific function 
- *       or file. Use it to approximate memory usage changes between code sections.
- * 
- * @warning Requires including <windows.h> and <psapi.h>. Also link against 
- *          Psapi.lib if compiling in Visual Studio.
+ * @brief Turns the command-line inputs into a sorted list of files
+ *
+ * Files are taken as they are. Directories contribute their regular files
+ * other than sidecars, and those of all subdirectories with @p recursive. A glob pattern is
+ * matched below its longest wildcard-free directory: a pattern without a
+ * further '/' (such as `dir/x*.cnf`) is matched against file names, in
+ * subdirectories too with @p recursive, and any other pattern, such as one
+ * using `**`, against the path relative to that directory.
+ *
+ * @return vector<string> Every matching file once, in path order
  */
+vector<string> expand_inputs(const vector<string>& inputs, bool recursive)
+{
+    vector<string> files;
+    auto add_dir = [&](const fs::path& dir, bool deep, const function<bool(const fs::path&)>& keep) {
+        error_code ec;
+        if (deep) {
+            for (auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (it->is_regular_file(ec) && keep(it->path())) files.push_back(it->path().string());
+            }
+        } else {
+            for (auto it = fs::directory_iterator(dir, ec); it != fs::directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (it->is_regular_file(ec) && keep(it->path())) files.push_back(it->path().string());
+            }
+        }
+    };
 
-size_t getMemoryKB() {
-    PROCESS_MEMORY_COUNTERS pmc;
-    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
-        return pmc.WorkingSetSize / 1024; // KB
+    for (const string& input : inputs) {
+        error_code ec;
+        string pattern = fs::path(input).generic_string();
+        size_t wildcard = pattern.find_first_of("*?[");
+
+        if (wildcard == string::npos) {
+            if (fs::is_directory(input, ec)) add_dir(input, recursive, [](const fs::path& p) { return !is_sidecar(p.string()); });
+            else if (fs::is_regular_file(input, ec)) files.push_back(input);
+            else cerr << "Warning: no such file or directory: " << input << endl;
+            continue;
+        }
+
+        size_t slash = pattern.rfind('/', wildcard);
+        fs::path base = slash == string::npos ? fs::path(".") : fs::path(pattern.substr(0, slash + 1));
+        string rest = slash == string::npos ? pattern : pattern.substr(slash + 1);
+        bool by_name = rest.find('/') == string::npos;
+
+        size_t before = files.size();
+        add_dir(base, recursive || !by_name, [&](const fs::path& p) {
+            string subject = by_name ? p.filename().generic_string() : p.lexically_relative(base).generic_string();
+            return glob_match(rest.c_str(), subject.c_str());
+        });
+        if (files.size() == before) cerr << "Warning: no files match " << input << endl;
     }
-    return 0;
+
+    sort(files.begin(), files.end());
+    files.erase(unique(files.begin(), files.end()), files.end());
+    return files;
 }
 
 /**
  * @brief Entry point for CNF formula analysis and validation.
  *
- * This program iterates through all CNF files in a specified folder,
- * applies CNF validity checking algorithms on each file, and generates
- * an HTML report summarizing the results.
+ * This program collects the CNF files named on the command line (files,
+ * directories and glob patterns, see expand_inputs()), analyzes them
+ * concurrently on a pool of worker threads (largest files first, see
+ * schedule_lpt()), and generates an HTML report
+ * summarizing the results. Rows are sorted by file path, so the report does
+ * not depend on which worker finished first. Files larger than
+ * PARALLEL_SPLIT_BYTES are instead analyzed one at a time, each split into
+ * byte ranges that all threads parse together (see cnf_validcno_split()).
+ *
+ * Tar archives (.tar, .tar.xz, .tar.gz, .tar.bz2) are read in a single
+ * pass and each CNF member is reported as "archive:member/path".
  *
  * Each file is analyzed for:
  * - Validity of the CNF formula (tautological or non-tautological)
  * - Number of valid and invalid clauses
  * - Execution time for the algorithm
- * - Memory used during the analysis
+ * - User and system CPU time of the analyzing thread
+ * - Peak heap and total bytes allocated during the analysis, and the
+ *   process peak RSS (see ResourceMeter)
+ *
+ * With `--dedup` every file is fingerprinted first (see CnfFingerprint) and
+ * only the first file of each group with equal fingerprints is analyzed;
+ * the others reuse its result and name it in their duplicate_of field.
+ *
+ * With `--solve` each formula is also decided satisfiable or unsatisfiable
+ * (see decide_satisfiability()); `--solve-time` bounds the search, after
+ * which the answer is UNKNOWN. Formulas that fall apart into independent
+ * components are solved component by component, in parallel. The report
+ * then adds the verdict, the component count and the decisions, conflicts
+ * and propagations per second.
+ *
+ * An analysis that runs past `--time-limit` or holds more heap than
+ * `--mem-limit` is stopped and reported as TIMEOUT or MEMOUT (see Budget).
+ *
+ * Every result is appended to an NDJSON file and a CSV file (next to the
+ * HTML report by default, see ResultLog) the moment its file is done, and
+ * stored in the result cache (see ResultCache). The HTML report is rendered
+ * from the same records, and `--html-from FILE` re-renders it from an
+ * existing record file, for example one left behind by an interrupted run.
  *
  * The results are presented in an HTML table with color-coded rows:
  * - **Green** for valid CNF formulas
  * - **Red** for invalid CNF formulas
+ * - **Grey** for files stopped by a limit
  *
- * @return Returns 0 on successful execution, -1 if the output file cannot be opened.
+ * A summary below the table gives the thread count, total wall-clock time,
+ * total CPU time and CPU utilization of the run.
  *
+ * @param argc Argument count
+ * @param argv Options and inputs, see print_usage() and parse_cli()
+ * @return Returns 0 on successful execution, -1 on a usage error or if an
+ *         output file cannot be opened.
  *
- * @see getMemoryKB()
- * @see cnf_validcno()
- * @see cnf_non_valid_cno()
- * @see cnf_validitychecker()
+ *
+ * @see analyze_file()
+ * @see parallel_for()
+ * @see schedule_lpt()
+ * @see ResourceMeter
+ * @see getCpuTimeMs()
  *
  * @par Output
- * Generates an HTML file named **Analysis.html** containing a formatted table of results.
+ * Generates **Analysis.ndjson** and **Analysis.csv** with one record per file,
+ * and an HTML file named **Analysis.html** containing a formatted table of results
+ * (see `--output` and `--format`).
  *
  * @par Example Output:
- * | File | Result | Valid Clauses | Invalid Clauses | Time (ms) | Memory (KB) |
- * |------|---------|---------------|-----------------|------------|--------------|
- * | example.cnf | Invalid | 0 | 125 | 45.2 | 678 |
+ * | File | Result | Valid Clauses | Invalid Clauses | Time (ms) | User CPU (ms) | System CPU (ms) | Heap Peak (KB) | Allocated (KB) | Peak RSS (KB) |
+ * |------|---------|---------------|-----------------|------------|---------------|-----------------|----------------|----------------|---------------|
+ * | example.cnf | Invalid | 0 | 125 | 45.2 | 44.1 | 0.9 | 1032 | 1101 | 6120 |
  *
  * @par Dependencies
- * Requires the C++17 `<filesystem>`, `<chrono>`, `<fstream>`, and `<windows.h>` headers.
+ * Requires the C++17 `<filesystem>`, `<chrono>`, `<thread>` and `<fstream>` headers, plus
+ * `<sys/resource.h>` on POSIX systems or `<windows.h>`/`<psapi.h>` on Windows.
  */
 
-int main() {
-    string folder_path = "D:\\Projects\\ParseTree-Generator-and-CNF-validity-checker\\cnfextractedfiles";
-    string output_file = "D:\\Projects\\ParseTree-Generator-and-CNF-validity-checker\\Analysis.html";
+int main(int argc, char* argv[]) {
+    CliOptions opt;
+    string error;
+    if (!parse_cli(argc, argv, opt, error)) {
+        cerr << "Error: " << error << endl;
+        print_usage(argv[0]);
+        return -1;
+    }
+    if (opt.help) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    unsigned threads = opt.threads;
+
+    // Rebuild the HTML view from an existing record file, e.g. after a crash
+    if (!opt.html_from.empty()) {
+        vector<CnfAnalysis> records = read_ndjson(opt.html_from);
+        if (!write_html_report(records, opt.output, nullptr)) {
+            cerr << "Failed to open output file!" << endl;
+            return -1;
+        }
+        cout << "HTML analysis generated from " << records.size() << " records: " << opt.output << endl;
+        return 0;
+    }
 
-    ofstream out(output_file);
-    if (!out) {
+    if (opt.inputs.empty()) {
+        cerr << "Error: no input files" << endl;
+        print_usage(argv[0]);
+        return -1;
+    }
+
+    if (opt.command == "verify") {
+        if (opt.inputs.size() != 2) {
+            cerr << "Error: verify takes a formula and an assignment file" << endl;
+            return -1;
+        }
+        return verify_models(opt.inputs[0], opt.inputs[1], threads);
+    }
+    if (opt.command == "drat") {
+        if (opt.inputs.size() != 2) {
+            cerr << "Error: drat takes a formula and a proof file" << endl;
+            return -1;
+        }
+        return check_proof(opt.inputs[0], opt.inputs[1], opt.analysis.limits);
+    }
+    if (opt.command == "simplify") {
+        if (opt.inputs.size() != 2) {
+            cerr << "Error: simplify takes a formula and an output file" << endl;
+            return -1;
+        }
+        return simplify_file(opt.inputs[0], opt.inputs[1], opt.analysis.limits, opt.simplify);
+    }
+
+    // Stat every input up front so the schedule can use file sizes
+    vector<string> paths = expand_inputs(opt.inputs, opt.recursive);
+    vector<uintmax_t> sizes;
+    for (const string& path : paths) {
+        error_code ec;
+        uintmax_t size = fs::file_size(path, ec);
+        sizes.push_back(ec ? 0 : size);
+    }
+    if (paths.empty()) {
+        cerr << "Error: no input files found" << endl;
+        return -1;
+    }
+
+    if (opt.command == "convert") return convert_files(paths, threads);
+    if (opt.bench.runs > 0) return run_benchmark(paths, sizes, opt.bench, threads);
+
+    ResultLog log(opt.write_ndjson ? opt.ndjson : "", opt.write_csv ? opt.csv : "");
+    if (!log.is_open()) {
         cerr << "Failed to open output file!" << endl;
         return -1;
     }
 
-    // --- HTML header ---
-    out << "<!DOCTYPE html>\n<html>\n<head>\n<title>CNF Analysis and Results</title>\n"
-        << "<style>\n"
-        << "table { border-collapse: collapse; width: 100%; }\n"
-        << "th, td { border: 1px solid black; padding: 8px; text-align: left; }\n"
-        << "th { background-color: #f2f2f2; }\n"
-        << "tr.invalid { background-color: #fdd; }\n"
-        << "tr.valid { background-color: #dfd; }\n"
-        << "</style>\n</head>\n<body>\n";
+    ResultCache cache(opt.use_cache ? opt.cache_file : "", opt.cache_hash, opt.revalidate);
+    size_t cache_hits = 0, duplicates = 0;
 
-    out << "<h1>CNF Files Analysis and Results</h1>\n";
-    out << "<table>\n";
-    out << "<tr><th>File</th><th>Result</th><th>Valid Clauses</th>"
-           "<th>Invalid Clauses</th><th>Time (ms)</th><th>Memory (KB)</th></tr>\n";
+    double cpu_before = getCpuTimeMs();
+    auto run_start = chrono::high_resolution_clock::now();
 
-    for (const auto& entry : fs::directory_iterator(folder_path)) {
-        if(entry.is_regular_file()) {
-            string path = entry.path().string();
+    // Unchanged files are answered from the result cache, unless a verdict
+    // is now wanted that the cached run did not compute
+    auto has_verdict = [&](const vector<CnfAnalysis>& records) {
+        return !opt.analysis.solve ||
+               all_of(records.begin(), records.end(), [](const CnfAnalysis& r) { return !r.sat.empty(); });
+    };
+    vector<size_t> todo;
+    for (size_t i = 0; i < paths.size(); i++) {
+        vector<CnfAnalysis> records;
+        if (opt.use_cache && cache.lookup(paths[i], records) && has_verdict(records)) {
+            cache_hits++;
+            for (const CnfAnalysis& r : records) log.write(r);
+        } else {
+            todo.push_back(i);
+        }
+    }
 
-            size_t memory_before = getMemoryKB();
-            auto start = chrono::high_resolution_clock::now();
+    // With --dedup, files with the same fingerprint are analyzed only once
+    vector<string> fingerprints(paths.size()), keys(paths.size());
+    vector<size_t> representative(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) representative[i] = i;
+    if (opt.dedup != Dedup::None) {
+        bool renaming = (opt.dedup == Dedup::Renaming);
+        parallel_for(todo.size(), threads, [&](size_t k) {
+            size_t i = todo[k];
+            CnfFingerprint fp;
+            if (is_tar_archive(paths[i]) || !fingerprint_file(paths[i], renaming, opt.analysis.use_sidecar, fp)) return;
+            fingerprints[i] = fp.exact_hex();
+            keys[i] = to_string(fp.var_no) + ":" + to_string(fp.clause_no) + ":" + (renaming ? fp.renaming_hex() : fp.exact_hex());
+        });
+        map<string, size_t> first;
+        for (size_t i : todo) {
+            if (!keys[i].empty()) representative[i] = first.emplace(keys[i], i).first->second;
+        }
+    }
 
-            int n1 = cnf_validcno(path);
-            bool ans = cnf_validitychecker(path);
-            int n2 = cnf_non_valid_cno(path);
+    // Files with a large clause body are split across all threads one at a
+    // time; the rest are spread over the pool, one file per worker
+    vector<size_t> split, pooled;
+    vector<uintmax_t> pooled_sizes;
+    for (size_t i : todo) {
+        if (representative[i] != i) continue;
+        if (threads > 1 && sizes[i] >= PARALLEL_SPLIT_BYTES && !is_tar_archive(paths[i])) {
+            split.push_back(i);
+        } else {
+            pooled.push_back(i);
+            pooled_sizes.push_back(sizes[i]);
+        }
+    }
+    vector<CorpusTask> tasks = schedule_lpt(pooled_sizes);
 
-            auto end = chrono::high_resolution_clock::now();
-            chrono::duration<double, milli> elapsed_ms = end - start;
-            size_t memory_after = getMemoryKB();
-            size_t memory_used = (memory_after > memory_before) ? 
-                                 (memory_after - memory_before) : 
-                                 (memory_before - memory_after);
+    // --- Analyze all files on the worker pool, logging each result as it finishes ---
+    vector<vector<CnfAnalysis>> results(paths.size());
+    auto process = [&](size_t i, unsigned file_threads) {
+        vector<CnfAnalysis>& records = results[i];
+        if (is_tar_archive(paths[i])) records = analyze_archive(paths[i], opt.analysis);
+        else records.push_back(analyze_file(paths[i], file_threads, opt.analysis));
+        for (CnfAnalysis& r : records) r.fingerprint = fingerprints[i];
+        if (opt.use_cache) cache.store(paths[i], records);
+        for (const CnfAnalysis& r : records) log.write(r);
+    };
 
-            // --- Table row with color based on validity ---
+    for (size_t i : split) {
+        process(i, threads);
+    }
+    parallel_for(tasks.size(), threads, [&](size_t t) {
+        for (size_t k : tasks[t].files) process(pooled[k], 1);
+    });
 
-            string filename = fs::path(path).filename().string();
-            out << "<tr class='" << (ans ? "valid" : "invalid") << "'>";
-            out << "<td>" << filename << "</td>";
-            out << "<td>" << (ans ? "Valid" : "Invalid") << "</td>";
-            out << "<td>" << n1 << "</td>";
-            out << "<td>" << n2 << "</td>";
-            out << "<td>" << elapsed_ms.count() << "</td>";
-            out << "<td>" << memory_used << "</td>";
-            out << "</tr>\n";
+    // Duplicates take over the result of the file analyzed in their place
+    for (size_t i : todo) {
+        if (representative[i] == i) continue;
+        vector<CnfAnalysis> records = results[representative[i]];
+        for (CnfAnalysis& r : records) {
+            r.path = paths[i];
+            r.fingerprint = fingerprints[i];
+            r.duplicate_of = paths[representative[i]];
+            r.time_ms = 0;
+            r.usage = FileResources();
         }
+        if (opt.use_cache) cache.store(paths[i], records);
+        for (const CnfAnalysis& r : records) log.write(r);
+        duplicates++;
     }
 
-    // --- Close HTML ---
-    out << "</table>\n</body>\n</html>\n";
-    out.close();
+    chrono::duration<double, milli> wall_ms = chrono::high_resolution_clock::now() - run_start;
+    RunSummary summary;
+    summary.threads = threads;
+    summary.wall_ms = wall_ms.count();
+    summary.cpu_ms = getCpuTimeMs() - cpu_before;
+    summary.utilization = summary.wall_ms > 0 ? 100.0 * summary.cpu_ms / (summary.wall_ms * threads) : 0;
+    vector<CnfAnalysis> records = log.records();
+    log.close();
+
+    size_t limited = 0;
+    for (const CnfAnalysis& r : records) {
+        if (!r.status.empty()) limited++;
+    }
+
+    cout << "Analyzed " << records.size() << " files on " << threads << " threads in "
+         << summary.wall_ms << " ms (CPU " << summary.cpu_ms << " ms, " << summary.utilization << "% utilization), "
+         << cache_hits << " files served from cache, " << duplicates << " duplicates, " << limited << " stopped by a limit" << endl;
+    if (opt.write_ndjson) cout << "Records written: " << opt.ndjson << endl;
+    if (opt.write_csv) cout << "Records written: " << opt.csv << endl;
 
-    cout << "HTML analysis generated: " << output_file << endl;
+    // --- The HTML report is a view over the logged records ---
+    if (opt.write_html) {
+        if (!write_html_report(records, opt.output, &summary)) {
+            cerr << "Failed to open output file!" << endl;
+            return -1;
+        }
+        cout << "HTML analysis generated: " << opt.output << endl;
+    }
     return 0;
 }
     